@@ -12,7 +12,7 @@ info()  { echo -e "${CYAN}[${1}/${TOTAL_STEPS}]${NC} ${2}"; }
 warn()  { echo -e "${YELLOW}[WARN]${NC} $*"; }
 die()   { echo -e "\n${RED}✗ ERROR:${NC} $*\n" >&2; show_help; exit 1; }
 
-TOTAL_STEPS=5
+TOTAL_STEPS=6
 
 # ── Parse arguments ───────────────────────────────────────────────────────────
 SKIP_NATIVE=false
@@ -30,19 +30,20 @@ show_help() {
     echo -e "  ${CYAN}Arch Linux / Manjaro:${NC}"
     echo "    sudo pacman -S cmake ninja extra-cmake-modules qt6-base qt6-declarative"
     echo "    sudo pacman -S kf6-config kf6-coreaddons plasma-framework"
-    echo "    sudo pacman -S qt6-shader-baker   # provides qsb"
+    echo "    sudo pacman -S qt6-shadertools    # provides qsb"
     echo
     echo -e "  ${CYAN}Ubuntu 24.04 / KDE Neon:${NC}"
     echo "    sudo apt install cmake ninja-build extra-cmake-modules"
     echo "    sudo apt install qt6-base-dev qt6-declarative-dev qt6-tools-dev"
     echo "    sudo apt install libkf6config-dev libkf6coreaddons-dev"
     echo "    sudo apt install libplasma-dev"
-    echo "    sudo apt install qt6-shader-baker  # provides qsb6"
+    echo "    sudo apt install qt6-shadertools-dev  # provides qsb"
     echo
     echo -e "  ${CYAN}Fedora:${NC}"
     echo "    sudo dnf install cmake ninja-build extra-cmake-modules"
     echo "    sudo dnf install qt6-qtbase-devel qt6-qtdeclarative-devel qt6-qttools-devel"
     echo "    sudo dnf install kf6-kconfig-devel kf6-kcoreaddons-devel plasma-devel"
+    echo "    sudo dnf install qt6-qtshadertools-devel  # provides qsb"
     echo
 }
 
@@ -60,53 +61,33 @@ fi
 PROJECT_DIR=$(pwd)
 BUILD_DIR="${PROJECT_DIR}/build_cpp"
 NATIVE_DIR="${PROJECT_DIR}/tao-widget/contents/ui/native"
+WALLPAPER_NATIVE_DIR="${PROJECT_DIR}/tao-wallpaper/contents/ui/wallpapernative"
 SHADER_SRC_DIR="${PROJECT_DIR}/tao-widget/src/shaders"
-SHADER_OUT_DIR="${NATIVE_DIR}/shaders"
+SHADERS="particle trail"
 
 # ── Step 1: Cleanup ───────────────────────────────────────────────────────────
 info 1 "Cleaning old artifacts..."
-rm -f tao-widget.plasmoid
+rm -f tao-widget.plasmoid tao-wallpaper.plasmoid
 if [ "${SKIP_NATIVE}" = false ]; then
     rm -f "${NATIVE_DIR}/libtaoplugin.so"
-    rm -f "${SHADER_OUT_DIR}/"*.qsb
 fi
+# I .qsb ora sono solo dentro libtaoplugin.so: via quelli delle build vecchie
+rm -rf "${NATIVE_DIR}/shaders"
 
-# ── Step 2: Compile shaders ───────────────────────────────────────────────────
+# ── Step 2: Check shader sources ──────────────────────────────────────────────
+# Gli shader vengono compilati da CMake (qt_add_shaders, Qt Shader Tools) e
+# incorporati in libtaoplugin.so: con --skip-native viaggiano con la .so.
 if [ "${SKIP_NATIVE}" = true ]; then
-    info 2 "Skipping shader compilation..."
-    for shader_type in vert frag; do
-        qsb="${SHADER_OUT_DIR}/particle.${shader_type}.qsb"
-        [ -f "${qsb}" ] \
-            || die "Compiled shader not found: ${qsb}\n\
-       With --skip-native the .qsb files must already be present.\n\
-       Compile them locally first with: ./build.sh"
-    done
-    ok "Using existing .qsb shaders."
+    info 2 "Skipping shader check (embedded in the native plugin)..."
 else
-    # Locate qsb — name varies by distro
-    if   command -v qsb   &>/dev/null; then QSB=$(command -v qsb)
-    elif command -v qsb6  &>/dev/null; then QSB=$(command -v qsb6)
-    elif [ -x "/usr/lib/qt6/bin/qsb" ]; then QSB="/usr/lib/qt6/bin/qsb"
-    else
-        die "qsb (Qt Shader Baker) not found.\n\
-       Make sure qt6-shader-baker (Arch) or qt6-tools-dev (Ubuntu) is installed."
-    fi
-
-    info 2 "Compiling GLSL shaders → QSB..."
-    mkdir -p "${SHADER_OUT_DIR}"
-
-    for shader_type in vert frag; do
-        src="${SHADER_SRC_DIR}/particle.${shader_type}"
-        out="${SHADER_OUT_DIR}/particle.${shader_type}.qsb"
-
-        [ -f "${src}" ] || die "Shader source not found: ${src}"
-
-        "${QSB}" --glsl "100 es,120,150" --hlsl 50 --msl 12 \
-            -o "${out}" "${src}" \
-            || die "Shader compilation failed for: ${src}\n\
-       Check that '${QSB}' supports the requested targets."
+    info 2 "Checking GLSL shader sources..."
+    for shader in ${SHADERS}; do
+        for shader_type in vert frag; do
+            src="${SHADER_SRC_DIR}/${shader}.${shader_type}"
+            [ -f "${src}" ] || die "Shader source not found: ${src}"
+        done
     done
-    ok "Shaders compiled."
+    ok "Shader sources found (compiled by CMake)."
 fi
 
 # ── Step 3: Compile native C++ plugin ─────────────────────────────────────────
@@ -164,11 +145,26 @@ command -v zip &>/dev/null \
 zip -r tao-widget.plasmoid tao-widget/ \
     -x "tao-widget/.git/*"        \
     -x "tao-widget/src/*"         \
+    -x "tao-widget/tools/*"       \
+    -x "tao-widget/tests/*"       \
     -x "tao-widget/CMakeLists.txt"\
     -x "tao-widget/reference/*"   \
     -x "tao-widget/screenshots/*" \
     || die "Failed to create .plasmoid archive."
 
+# ── Step 6: Create wallpaper package ─────────────────────────────────────────
+# Stesso plugin nativo, ma come modulo QML distinto (wallpapernative, file
+# libtaowallpaperplugin.so): widget e sfondo possono convivere in plasmashell
+# senza due librerie diverse registrate sullo stesso URI "native".
+info 6 "Generating tao-wallpaper.plasmoid..."
+mkdir -p "${WALLPAPER_NATIVE_DIR}"
+rm -rf "${PROJECT_DIR}/tao-wallpaper/contents/ui/native"   # copia delle build precedenti
+cp "${NATIVE_DIR}/libtaoplugin.so" "${WALLPAPER_NATIVE_DIR}/libtaowallpaperplugin.so"
+
+zip -r tao-wallpaper.plasmoid tao-wallpaper/ \
+    || die "Failed to create wallpaper archive."
+ok "Wallpaper package created."
+
 # ── Final report ──────────────────────────────────────────────────────────────
 if [ -f "tao-widget.plasmoid" ]; then
     SIZE=$(du -sh tao-widget.plasmoid | cut -f1)
@@ -178,11 +174,12 @@ if [ -f "tao-widget.plasmoid" ]; then
     echo -e "========================================${NC}"
     echo
     echo -e "  Package:       ${BOLD}tao-widget.plasmoid${NC} (${SIZE})"
+    echo -e "  Wallpaper:     ${BOLD}tao-wallpaper.plasmoid${NC}"
     echo -e "  Native plugin: ${BOLD}${NATIVE_DIR}/libtaoplugin.so${NC}"
-    echo -e "  Shaders:       ${BOLD}${SHADER_OUT_DIR}/${NC}"
     echo
     echo -e "${BOLD}Install / update:${NC}"
     echo "  kpackagetool6 -t Plasma/Applet --install tao-widget.plasmoid"
+    echo "  kpackagetool6 -t Plasma/Wallpaper --install tao-wallpaper.plasmoid"
     echo
     echo -e "${BOLD}Force reinstall (if already installed):${NC}"
     echo "  kpackagetool6 -t Plasma/Applet --remove  org.kde.plasma.taowidget"
@@ -0,0 +1,48 @@
+import QtQuick
+import QtQuick.Window
+import "wallpapernative" as TaoNative
+
+Item {
+    id: scene
+
+    // Configurazione del wallpaper (passata da main.qml)
+    property QtObject cfg: null
+
+    anchors.fill: parent
+
+    TaoNative.TaoNew {
+        anchors.fill: parent
+        // Una sola simulazione per tutti gli schermi, nello spazio del desktop:
+        // ogni schermo disegna solo le particelle del proprio viewport e il Tao
+        // sta al centro dell'intera area.
+        sharedGroup: scene.cfg && scene.cfg.spanScreens ? "tao-wallpaper" : ""
+        viewport: Qt.rect(scene.Screen.virtualX, scene.Screen.virtualY, width, height)
+        lodEnabled: false
+        particleCount: scene.cfg ? scene.cfg.particleCount : 0
+        rotationSpeed: scene.cfg ? scene.cfg.rotationSpeed : 0
+        clockwise: scene.cfg ? scene.cfg.clockwise : true
+        showClock: scene.cfg ? scene.cfg.showClock : false
+        // Clock Colors
+        hourHandColor: scene.cfg ? scene.cfg.hourHandColor : "white"
+        minuteHandColor: scene.cfg ? scene.cfg.minuteHandColor : "blue"
+        secondHandColor: scene.cfg ? scene.cfg.secondHandColor : "red"
+        // Glow
+        glowColor1: scene.cfg ? scene.cfg.glowColor1 : "white"
+        glowSize1: scene.cfg ? scene.cfg.glowSize1 : 0
+        glowColor2: scene.cfg ? scene.cfg.glowColor2 : "white"
+        glowSize2: scene.cfg ? scene.cfg.glowSize2 : 0
+        // Particle Colors
+        particleColor1: scene.cfg ? scene.cfg.particleColor1 : "white"
+        particleColor2: scene.cfg ? scene.cfg.particleColor2 : "white"
+        particleSize: scene.cfg ? scene.cfg.particleSize : 4.0
+        particleSizeRandom: scene.cfg ? scene.cfg.particleSizeRandom : 8.0
+        // Obstacles
+        obstacleShapes: scene.cfg ? scene.cfg.obstacleShapes : 1
+        // Flow field
+        flowEnabled: scene.cfg ? scene.cfg.flowEnabled : false
+        flowStrength: scene.cfg ? scene.cfg.flowStrength : 0.4
+        flowScale: scene.cfg ? scene.cfg.flowScale : 0.35
+        flowSwirl: scene.cfg ? scene.cfg.flowSwirl : 0.5
+    }
+
+}
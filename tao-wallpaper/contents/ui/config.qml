@@ -0,0 +1,100 @@
+import QtQuick
+import QtQuick.Controls as QQC2
+import QtQuick.Layouts
+import org.kde.kirigami as Kirigami
+import org.kde.kquickcontrols as KQuickControls
+
+Kirigami.FormLayout {
+    property alias cfg_spanScreens: spanScreensCheckBox.checked
+    property alias cfg_backgroundColor: backgroundColorButton.color
+    property alias cfg_rotationSpeed: rotationSpeedSlider.value
+    property alias cfg_clockwise: clockwiseCheckBox.checked
+    property alias cfg_particleCount: particleCountSlider.value
+    property alias cfg_particleColor1: particleColor1Button.color
+    property alias cfg_particleColor2: particleColor2Button.color
+    property alias cfg_flowEnabled: flowEnabledCheckBox.checked
+    property alias cfg_showClock: showClockCheckBox.checked
+
+    QQC2.CheckBox {
+        id: spanScreensCheckBox
+
+        Kirigami.FormData.label: i18n("Screens:")
+        text: i18n("One animation across all screens")
+    }
+
+    KQuickControls.ColorButton {
+        id: backgroundColorButton
+
+        Kirigami.FormData.label: i18n("Background:")
+    }
+
+    RowLayout {
+        Kirigami.FormData.label: i18n("Rotation speed:")
+
+        QQC2.Slider {
+            id: rotationSpeedSlider
+
+            Layout.fillWidth: true
+            from: 0
+            to: 100
+            stepSize: 1
+        }
+
+        QQC2.Label {
+            text: Math.round(rotationSpeedSlider.value)
+        }
+
+    }
+
+    QQC2.CheckBox {
+        id: clockwiseCheckBox
+
+        Kirigami.FormData.label: i18n("Direction:")
+        text: i18n("Clockwise")
+    }
+
+    RowLayout {
+        Kirigami.FormData.label: i18n("Particles:")
+
+        QQC2.Slider {
+            id: particleCountSlider
+
+            Layout.fillWidth: true
+            from: 0
+            to: 3000
+            stepSize: 50
+        }
+
+        QQC2.Label {
+            text: Math.round(particleCountSlider.value)
+        }
+
+    }
+
+    KQuickControls.ColorButton {
+        id: particleColor1Button
+
+        Kirigami.FormData.label: i18n("Primary color:")
+    }
+
+    KQuickControls.ColorButton {
+        id: particleColor2Button
+
+        Kirigami.FormData.label: i18n("Secondary color:")
+    }
+
+    QQC2.CheckBox {
+        id: flowEnabledCheckBox
+
+        Kirigami.FormData.label: i18n("Flow:")
+        text: i18n("Drift along swirling currents")
+    }
+
+    QQC2.CheckBox {
+        id: showClockCheckBox
+
+        Kirigami.FormData.label: i18n("Clock:")
+        text: i18n("Show clock hands")
+    }
+
+}
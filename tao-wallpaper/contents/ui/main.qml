@@ -0,0 +1,29 @@
+import QtQuick
+import org.kde.plasma.plasmoid
+
+WallpaperItem {
+    id: root
+
+    Rectangle {
+        anchors.fill: parent
+        color: root.configuration.backgroundColor
+    }
+
+    // Il motore nativo è caricato a parte: se il plugin manca resta lo sfondo
+    // in tinta unita invece di un wallpaper rotto
+    Loader {
+        id: sceneLoader
+
+        anchors.fill: parent
+        source: "TaoScene.qml"
+
+        Binding {
+            target: sceneLoader.item
+            property: "cfg"
+            value: root.configuration
+            when: sceneLoader.status === Loader.Ready
+        }
+
+    }
+
+}
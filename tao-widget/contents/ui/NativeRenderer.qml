@@ -6,19 +6,13 @@ Item {
 
     // 1. Riceviamo l'oggetto unificato 'settings' dal main.qml
     property QtObject objsettings: null
-    // 2. Manteniamo la proprietà interna per il mouse (che serve al componente ibrido)
-    property point mousePos: Qt.point(-1000, -1000)
-
-    // 3. Funzione pubblica per aggiornare il mouse (chiamata dal main.qml)
-    function updateMouse(x, y, inside) {
-        renderer.mousePos = inside ? Qt.point(x, y) : Qt.point(-1000, -1000);
-    }
+    // 2. Hover e tocco vengono gestiti direttamente da TaoNew (nessun MouseArea)
 
     anchors.fill: parent
 
     // Backend Nativo/Ibrido
     TaoNative.TaoNew {
-        // 4. Colleghiamo le proprietà del componente ai valori dentro 'settings'.
+        // 3. Colleghiamo le proprietà del componente ai valori dentro 'settings'.
         // Il controllo (renderer.settings ? ... : default) serve per evitare errori
         // nel millisecondo in cui il Loader crea l'oggetto ma il binding non è ancora arrivato.
 
@@ -27,6 +21,7 @@ Item {
         rotationSpeed: renderer.objsettings ? renderer.objsettings.rotationSpeed : 0
         clockwise: renderer.objsettings ? renderer.objsettings.clockwise : false
         showClock: renderer.objsettings ? renderer.objsettings.showClock : false
+        softwareRendering: renderer.objsettings ? renderer.objsettings.softwareRendering : false
         // Clock Colors
         hourHandColor: renderer.objsettings ? renderer.objsettings.hourHandColor : "white"
         minuteHandColor: renderer.objsettings ? renderer.objsettings.minuteHandColor : "blue"
@@ -41,8 +36,22 @@ Item {
         particleColor2: renderer.objsettings ? renderer.objsettings.particleColor2 : "white"
         particleSize: renderer.objsettings ? renderer.objsettings.particleSize : 2.0
         particleSizeRandom: renderer.objsettings ? renderer.objsettings.particleSizeRandom : 8.0
-        // Il mouse usa la proprietà locale aggiornata dalla funzione sopra
-        mousePos: renderer.mousePos
+        // Trails
+        trailEnabled: renderer.objsettings ? renderer.objsettings.trailEnabled : false
+        trailDecay: renderer.objsettings ? renderer.objsettings.trailDecay : 0.9
+        trailResolution: renderer.objsettings ? renderer.objsettings.trailResolution : 0.5
+        // Level of detail
+        lodEnabled: renderer.objsettings ? renderer.objsettings.lodEnabled : true
+        lodFullSize: renderer.objsettings ? renderer.objsettings.lodFullSize : 300
+        lodMinSize: renderer.objsettings ? renderer.objsettings.lodMinSize : 64
+        // Obstacles
+        obstacleShapes: renderer.objsettings ? renderer.objsettings.obstacleShapes : 1
+        obstacleMask: renderer.objsettings ? renderer.objsettings.obstacleMask : ""
+        // Flow field
+        flowEnabled: renderer.objsettings ? renderer.objsettings.flowEnabled : false
+        flowStrength: renderer.objsettings ? renderer.objsettings.flowStrength : 0.4
+        flowScale: renderer.objsettings ? renderer.objsettings.flowScale : 0.35
+        flowSwirl: renderer.objsettings ? renderer.objsettings.flowSwirl : 0.5
     }
 
 }
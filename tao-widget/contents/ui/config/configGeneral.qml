@@ -15,7 +15,7 @@ KCM.SimpleKCM {
             id: engineCombo
 
             Kirigami.FormData.label: i18n("Render Engine:")
-            model: [i18n("WebGL (Browser)"), i18n("Zen (Native C++)")]
+            model: [i18n("WebGL (Browser)"), i18n("Zen (Native C++)"), i18n("Zen Software (CPU only)")]
         }
 
         // Zen Engine Status Message
@@ -1,5 +1,6 @@
 import QtQuick
 import QtQuick.Controls as QQC2
+import QtQuick.Dialogs as QtDialogs
 import QtQuick.Layouts
 import org.kde.kcmutils as KCM
 import org.kde.kirigami as Kirigami
@@ -11,6 +12,22 @@ KCM.SimpleKCM {
     property alias cfg_particleColor2: particleColor2Button.color
     property alias cfg_particleSize: particleSizeSlider.value
     property alias cfg_particleSizeRandom: particleSizeRandomSlider.value
+    property alias cfg_trailEnabled: trailEnabledCheckBox.checked
+    property alias cfg_trailDecay: trailDecaySlider.value
+    property alias cfg_trailResolution: trailResolutionSlider.value
+    property alias cfg_lodEnabled: lodEnabledCheckBox.checked
+    property alias cfg_lodFullSize: lodFullSizeSpinBox.value
+    property alias cfg_lodMinSize: lodMinSizeSpinBox.value
+    property int cfg_obstacleShapes
+    property alias cfg_obstacleMask: obstacleMaskField.text
+    property alias cfg_flowEnabled: flowEnabledCheckBox.checked
+    property alias cfg_flowStrength: flowStrengthSlider.value
+    property alias cfg_flowScale: flowScaleSlider.value
+    property alias cfg_flowSwirl: flowSwirlSlider.value
+
+    function setObstacleShape(bit, on) {
+        cfg_obstacleShapes = on ? (cfg_obstacleShapes | bit) : (cfg_obstacleShapes & ~bit);
+    }
 
     Kirigami.FormLayout {
         anchors.fill: parent
@@ -103,6 +120,214 @@ KCM.SimpleKCM {
 
         }
 
+        Kirigami.Separator {
+            Kirigami.FormData.isSection: true
+            Kirigami.FormData.label: i18n("Trails")
+        }
+
+        QQC2.CheckBox {
+            id: trailEnabledCheckBox
+
+            Kirigami.FormData.label: i18n("Trails:")
+            text: i18n("Leave fading trails (Zen engine only)")
+        }
+
+        RowLayout {
+            Kirigami.FormData.label: i18n("Length:")
+            enabled: trailEnabledCheckBox.checked
+
+            QQC2.Slider {
+                id: trailDecaySlider
+
+                Layout.fillWidth: true
+                from: 0.5
+                to: 0.99
+                stepSize: 0.01
+            }
+
+            QQC2.Label {
+                text: trailDecaySlider.value.toFixed(2)
+            }
+
+        }
+
+        RowLayout {
+            Kirigami.FormData.label: i18n("Resolution:")
+            enabled: trailEnabledCheckBox.checked
+
+            QQC2.Slider {
+                id: trailResolutionSlider
+
+                Layout.fillWidth: true
+                from: 0.1
+                to: 1
+                stepSize: 0.05
+            }
+
+            QQC2.Label {
+                text: Math.round(trailResolutionSlider.value * 100) + "%"
+            }
+
+        }
+
+        Kirigami.Separator {
+            Kirigami.FormData.isSection: true
+            Kirigami.FormData.label: i18n("Level of Detail")
+        }
+
+        QQC2.CheckBox {
+            id: lodEnabledCheckBox
+
+            Kirigami.FormData.label: i18n("Small sizes:")
+            text: i18n("Reduce detail automatically")
+        }
+
+        QQC2.SpinBox {
+            id: lodFullSizeSpinBox
+
+            Kirigami.FormData.label: i18n("Full detail from (px):")
+            enabled: lodEnabledCheckBox.checked
+            from: 32
+            to: 4000
+            stepSize: 10
+        }
+
+        QQC2.SpinBox {
+            id: lodMinSizeSpinBox
+
+            Kirigami.FormData.label: i18n("Panel icon up to (px):")
+            enabled: lodEnabledCheckBox.checked
+            from: 0
+            to: lodFullSizeSpinBox.value
+            stepSize: 8
+        }
+
+        Kirigami.Separator {
+            Kirigami.FormData.isSection: true
+            Kirigami.FormData.label: i18n("Obstacles")
+        }
+
+        QQC2.CheckBox {
+            Kirigami.FormData.label: i18n("Particles bounce off:")
+            text: i18n("Tao symbol")
+            checked: (cfg_obstacleShapes & 1) !== 0
+            onToggled: setObstacleShape(1, checked)
+        }
+
+        QQC2.CheckBox {
+            text: i18n("Inner dots")
+            checked: (cfg_obstacleShapes & 2) !== 0
+            onToggled: setObstacleShape(2, checked)
+        }
+
+        QQC2.CheckBox {
+            text: i18n("Clock hands")
+            checked: (cfg_obstacleShapes & 4) !== 0
+            onToggled: setObstacleShape(4, checked)
+        }
+
+        QQC2.CheckBox {
+            id: obstacleMaskCheckBox
+
+            text: i18n("Custom mask (Zen engine only)")
+            checked: (cfg_obstacleShapes & 8) !== 0
+            onToggled: setObstacleShape(8, checked)
+        }
+
+        RowLayout {
+            Kirigami.FormData.label: i18n("Mask image:")
+            enabled: obstacleMaskCheckBox.checked
+
+            QQC2.TextField {
+                id: obstacleMaskField
+
+                Layout.fillWidth: true
+                placeholderText: i18n("Opaque or dark areas block particles")
+            }
+
+            QQC2.Button {
+                icon.name: "document-open"
+                onClicked: obstacleMaskDialog.open()
+            }
+
+        }
+
+        QtDialogs.FileDialog {
+            id: obstacleMaskDialog
+
+            nameFilters: [i18n("Images (*.png *.svg *.jpg *.webp)")]
+            onAccepted: obstacleMaskField.text = selectedFile.toString()
+        }
+
+        Kirigami.Separator {
+            Kirigami.FormData.isSection: true
+            Kirigami.FormData.label: i18n("Flow")
+        }
+
+        QQC2.CheckBox {
+            id: flowEnabledCheckBox
+
+            Kirigami.FormData.label: i18n("Flow:")
+            text: i18n("Drift along swirling currents (Zen engine only)")
+        }
+
+        RowLayout {
+            Kirigami.FormData.label: i18n("Strength:")
+            enabled: flowEnabledCheckBox.checked
+
+            QQC2.Slider {
+                id: flowStrengthSlider
+
+                Layout.fillWidth: true
+                from: 0
+                to: 3
+                stepSize: 0.05
+            }
+
+            QQC2.Label {
+                text: flowStrengthSlider.value.toFixed(2)
+            }
+
+        }
+
+        RowLayout {
+            Kirigami.FormData.label: i18n("Eddy size:")
+            enabled: flowEnabledCheckBox.checked
+
+            QQC2.Slider {
+                id: flowScaleSlider
+
+                Layout.fillWidth: true
+                from: 0.1
+                to: 2
+                stepSize: 0.05
+            }
+
+            QQC2.Label {
+                text: flowScaleSlider.value.toFixed(2)
+            }
+
+        }
+
+        RowLayout {
+            Kirigami.FormData.label: i18n("Swirl:")
+            enabled: flowEnabledCheckBox.checked
+
+            QQC2.Slider {
+                id: flowSwirlSlider
+
+                Layout.fillWidth: true
+                from: 0
+                to: 2
+                stepSize: 0.05
+            }
+
+            QQC2.Label {
+                text: flowSwirlSlider.value.toFixed(2)
+            }
+
+        }
+
 
     }
 
@@ -13,7 +13,7 @@ PlasmoidItem {
     property bool clockwise: plasmoid.configuration.clockwise
     property bool showClock: plasmoid.configuration.showClock
     property bool transparentBackground: plasmoid.configuration.transparentBackground
-    property int renderEngine: plasmoid.configuration.renderEngine // 0: WebGL, 1: Native
+    property int renderEngine: plasmoid.configuration.renderEngine // 0: WebGL, 1: Native, 2: Native su CPU
     // Clock Colors
     property color hourHandColor: plasmoid.configuration.hourHandColor
     property color minuteHandColor: plasmoid.configuration.minuteHandColor
@@ -28,6 +28,22 @@ PlasmoidItem {
     property color particleColor2: plasmoid.configuration.particleColor2
     property double particleSize: plasmoid.configuration.particleSize
     property double particleSizeRandom: plasmoid.configuration.particleSizeRandom
+    // Trails
+    property bool trailEnabled: plasmoid.configuration.trailEnabled
+    property double trailDecay: plasmoid.configuration.trailDecay
+    property double trailResolution: plasmoid.configuration.trailResolution
+    // Level of detail
+    property bool lodEnabled: plasmoid.configuration.lodEnabled
+    property int lodFullSize: plasmoid.configuration.lodFullSize
+    property int lodMinSize: plasmoid.configuration.lodMinSize
+    // Obstacles
+    property int obstacleShapes: plasmoid.configuration.obstacleShapes
+    property string obstacleMask: plasmoid.configuration.obstacleMask
+    // Flow field
+    property bool flowEnabled: plasmoid.configuration.flowEnabled
+    property double flowStrength: plasmoid.configuration.flowStrength
+    property double flowScale: plasmoid.configuration.flowScale
+    property double flowSwirl: plasmoid.configuration.flowSwirl
 
     Plasmoid.backgroundHints: root.transparentBackground ? PlasmaCore.Types.NoBackground : PlasmaCore.Types.DefaultBackground
     preferredRepresentation: fullRepresentation
@@ -51,6 +67,7 @@ PlasmoidItem {
             readonly property int rotationSpeed: root.rotationSpeed
             readonly property bool clockwise: root.clockwise
             readonly property bool showClock: root.showClock
+            readonly property bool softwareRendering: root.renderEngine === 2
             // Clock
             readonly property color hourHandColor: root.hourHandColor
             readonly property color minuteHandColor: root.minuteHandColor
@@ -65,6 +82,22 @@ PlasmoidItem {
             readonly property color particleColor2: root.particleColor2
             readonly property double particleSize: root.particleSize
             readonly property double particleSizeRandom: root.particleSizeRandom
+            // Trails
+            readonly property bool trailEnabled: root.trailEnabled
+            readonly property double trailDecay: root.trailDecay
+            readonly property double trailResolution: root.trailResolution
+            // Level of detail
+            readonly property bool lodEnabled: root.lodEnabled
+            readonly property int lodFullSize: root.lodFullSize
+            readonly property int lodMinSize: root.lodMinSize
+            // Obstacles
+            readonly property int obstacleShapes: root.obstacleShapes
+            readonly property string obstacleMask: root.obstacleMask
+            // Flow field
+            readonly property bool flowEnabled: root.flowEnabled
+            readonly property double flowStrength: root.flowStrength
+            readonly property double flowScale: root.flowScale
+            readonly property double flowSwirl: root.flowSwirl
         }
 
         Rectangle {
@@ -79,8 +112,8 @@ PlasmoidItem {
                 id: nativeLoader
 
                 anchors.fill: parent
-                // Attivo SOLO se engine == 1
-                active: root.renderEngine === 1
+                // Attivo SOLO se engine == 1 (GPU) o 2 (CPU)
+                active: root.renderEngine === 1 || root.renderEngine === 2
                 visible: active && status === Loader.Ready
                 source: "NativeRenderer.qml"
 
@@ -100,7 +133,7 @@ PlasmoidItem {
 
                 anchors.fill: parent
                 // Attivo se engine == 0 OPPURE se il nativo fallisce
-                active: (root.renderEngine === 0 || (root.renderEngine === 1 && nativeLoader.status === Loader.Error))
+                active: (root.renderEngine === 0 || (nativeLoader.active && nativeLoader.status === Loader.Error))
                 visible: active
                 source: "WebRenderer.qml"
 
@@ -114,19 +147,20 @@ PlasmoidItem {
 
             }
 
-            // --- 4. MOUSE AREA UNIFICATA ---
+            // --- 4. MOUSE AREA (solo WebGL) ---
+            // Il motore nativo riceve hover e tocco direttamente: qui passerebbero
+            // per JS a ogni evento del dispositivo.
             MouseArea {
-                // Funzione helper per smistare l'evento al loader attivo
+                // Funzione helper per inoltrare l'evento alla pagina web
                 function dispatchMouse(x, y, inside) {
-                    var item = nativeLoader.item || webLoader.item;
-                    if (item)
-                        item.updateMouse(x, y, inside);
+                    if (webLoader.item)
+                        webLoader.item.updateMouse(x, y, inside);
 
                 }
 
                 anchors.fill: parent
-                hoverEnabled: true
-                enabled: true
+                hoverEnabled: enabled
+                enabled: webLoader.active
                 onPositionChanged: (mouse) => {
                     return dispatchMouse(mouse.x, mouse.y, true);
                 }
@@ -0,0 +1,154 @@
+#include "FlowField.h"
+#include "ParticleSystem.h"
+
+#include <cmath>
+#include <utility>
+
+// Velocità di avanzamento del rumore nel tempo (unità rumore / s) e passo
+// delle differenze centrali con cui si prende il curl
+static constexpr float NOISE_SPEED = 0.12f;
+static constexpr float CURL_EPS    = 0.01f;
+
+// ── Value noise 3D ────────────────────────────────────────────────────────────
+// Reticolo intero con hash senza tabelle: deterministico e senza stato.
+
+static inline float lattice(int x, int y, int z)
+{
+    quint32 h = static_cast<quint32>(x) * 0x8DA6B343u
+              ^ static_cast<quint32>(y) * 0xD8163841u
+              ^ static_cast<quint32>(z) * 0xCB1AB31Fu;
+    h ^= h >> 13;
+    h *= 0x5BD1E995u;
+    h ^= h >> 15;
+    return static_cast<float>(h & 0xFFFFFFu) * (2.0f / 16777215.0f) - 1.0f;
+}
+
+static inline float fade(float t)
+{
+    return t * t * t * (t * (t * 6.0f - 15.0f) + 10.0f);
+}
+
+static float valueNoise(float x, float y, float z)
+{
+    const float fx = std::floor(x), fy = std::floor(y), fz = std::floor(z);
+    const int   ix = static_cast<int>(fx), iy = static_cast<int>(fy), iz = static_cast<int>(fz);
+    const float u  = fade(x - fx), v = fade(y - fy), w = fade(z - fz);
+
+    const auto lerp = [](float a, float b, float t) { return a + (b - a) * t; };
+    const float x00 = lerp(lattice(ix, iy,     iz),     lattice(ix + 1, iy,     iz),     u);
+    const float x10 = lerp(lattice(ix, iy + 1, iz),     lattice(ix + 1, iy + 1, iz),     u);
+    const float x01 = lerp(lattice(ix, iy,     iz + 1), lattice(ix + 1, iy,     iz + 1), u);
+    const float x11 = lerp(lattice(ix, iy + 1, iz + 1), lattice(ix + 1, iy + 1, iz + 1), u);
+    return lerp(lerp(x00, x10, v), lerp(x01, x11, v), w);
+}
+
+// ═════════════════════════════════════════════════════════════════════════════
+// FlowField
+// ═════════════════════════════════════════════════════════════════════════════
+
+FlowField::FlowField()
+{
+    for (auto &g : m_grids)
+        g.assign(static_cast<size_t>(GRID) * GRID * 2, 0.0f);
+}
+
+void FlowField::reset()
+{
+    // Il prossimo update() rifà il bake completo in m_front
+    m_front   = &m_grids[0];
+    m_back    = &m_grids[1];
+    m_nextRow = 0;
+    m_empty   = true;
+    m_w = m_h = m_scale = -1.0f;
+}
+
+void FlowField::update(const SimulationParams &p, float time)
+{
+    if (p.flowStrength <= 0.0f) {
+        m_empty = true;
+        return;
+    }
+
+    // Ciclo di bake: i parametri si fissano alla prima riga, così tutta la
+    // griglia in costruzione descrive lo stesso istante
+    const auto beginCycle = [&] {
+        m_bakeTime = time * NOISE_SPEED;
+        m_rotation = p.taoRotation;
+        m_swirl    = p.flowSwirl;
+    };
+
+    if (m_empty || p.w != m_w || p.h != m_h || p.flowScale != m_scale) {
+        // Geometria nuova (o flusso appena attivato): bake completo una volta
+        m_w     = p.w;
+        m_h     = p.h;
+        m_scale = p.flowScale;
+
+        const float side = qMax(qMax(p.w, p.h), 1.0f);
+        m_cell    = side / (GRID - 1);
+        m_invCell = 1.0f / m_cell;
+        m_gw      = qBound(2, static_cast<int>(std::ceil(p.w / m_cell)) + 1, GRID);
+        m_gh      = qBound(2, static_cast<int>(std::ceil(p.h / m_cell)) + 1, GRID);
+        m_maxX    = static_cast<float>(m_gw - 1) - 0.001f;
+        m_maxY    = static_cast<float>(m_gh - 1) - 0.001f;
+
+        beginCycle();
+        bakeRows(*m_front, 0, m_gh);
+        m_nextRow = 0;
+        m_empty   = false;
+        return;
+    }
+
+    if (m_nextRow == 0)
+        beginCycle();
+
+    const int to = qMin(m_nextRow + ROWS_PER_STEP, m_gh);
+    bakeRows(*m_back, m_nextRow, to);
+    m_nextRow = to;
+
+    if (m_nextRow == m_gh) {
+        std::swap(m_front, m_back);
+        m_nextRow = 0;
+    }
+}
+
+// ── Bake ──────────────────────────────────────────────────────────────────────
+// ψ = rumore (due ottave) + vortice gaussiano di raggio 2r centrato sul Tao;
+// v = (∂ψ/∂y, −∂ψ/∂x) è a divergenza nulla per costruzione. Il rumore si
+// valuta nel riferimento ruotato del Tao, poi la velocità torna nel
+// riferimento item: il pattern gira insieme al simbolo.
+
+void FlowField::bakeRows(std::vector<float> &grid, int from, int to) const
+{
+    const float cx   = m_w * 0.5f;
+    const float cy   = m_h * 0.5f;
+    const float freq = 1.0f / (qMax(m_scale, 0.01f) * qMax(qMin(m_w, m_h), 1.0f));
+    const float r    = qMin(m_w, m_h) / 4.5f;
+    const float R    = qMax(2.0f * r * freq, 1e-3f);
+    const float inv2R2 = 0.5f / (R * R);
+    const float s    = std::sin(m_rotation);
+    const float c    = std::cos(m_rotation);
+    const float t    = m_bakeTime;
+
+    const auto psi = [&](float x, float y) {
+        const float n = valueNoise(x, y, t)
+                      + 0.5f * valueNoise(2.0f * x + 17.3f, 2.0f * y - 9.1f, 1.7f * t);
+        return 0.5f * n + m_swirl * R * std::exp(-(x * x + y * y) * inv2R2);
+    };
+
+    for (int j = from; j < to; ++j) {
+        const float dy = j * m_cell - cy;
+        float *row = grid.data() + 2 * j * m_gw;
+        for (int i = 0; i < m_gw; ++i) {
+            const float dx = i * m_cell - cx;
+            // Riferimento del Tao (rotazione di −θ), in unità rumore
+            const float nx = ( c * dx + s * dy) * freq;
+            const float ny = (-s * dx + c * dy) * freq;
+
+            const float vx = (psi(nx, ny + CURL_EPS) - psi(nx, ny - CURL_EPS)) * (0.5f / CURL_EPS);
+            const float vy = (psi(nx - CURL_EPS, ny) - psi(nx + CURL_EPS, ny)) * (0.5f / CURL_EPS);
+
+            row[2 * i]     = c * vx - s * vy;
+            row[2 * i + 1] = s * vx + c * vy;
+        }
+    }
+}
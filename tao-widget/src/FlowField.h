@@ -0,0 +1,91 @@
+#ifndef FLOWFIELD_H
+#define FLOWFIELD_H
+
+#include <QtGlobal>
+#include <vector>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+struct SimulationParams;
+
+// ── FlowField ─────────────────────────────────────────────────────────────────
+// Flusso ambientale a divergenza nulla: curl di una funzione di corrente
+// (value noise 3D nel tempo + vortice gaussiano attorno al Tao) campionato su
+// una griglia di al più GRID×GRID nodi, vettori interleaved (vx, vy).
+// Il pattern ruota con il Tao. La griglia visibile viene sostituita in blocco;
+// quella successiva si costruisce poche righe per step, così nessuno step
+// paga un bake completo e il kernel non valuta mai il rumore.
+
+class FlowField
+{
+public:
+    static constexpr int GRID          = 32;
+    static constexpr int ROWS_PER_STEP = 8;
+
+    FlowField();
+
+    // Avanza il bake incrementale; `time` è il tempo di simulazione (s)
+    void update(const SimulationParams &params, float time);
+
+    // Torna allo stato iniziale: griglie scartate, ciclo di bake da capo
+    void reset();
+
+    bool isEmpty() const { return m_empty; }
+
+    // Velocità del flusso (unità del campo, da moltiplicare per la forza)
+    void sample(float x, float y, float *vx, float *vy) const
+    {
+        float fx = x * m_invCell;
+        float fy = y * m_invCell;
+        fx = qBound(0.0f, fx, m_maxX);
+        fy = qBound(0.0f, fy, m_maxY);
+        const int   ix = static_cast<int>(fx);
+        const int   iy = static_cast<int>(fy);
+        const float tx = fx - ix;
+        const float ty = fy - iy;
+
+        // Nodi (ix, iy) e (ix+1, iy) sono contigui: 4 float per riga
+        const float *r0 = m_front->data() + 2 * (iy * m_gw + ix);
+        const float *r1 = r0 + 2 * m_gw;
+#if defined(__SSE2__)
+        const __m128 a  = _mm_loadu_ps(r0);                    // x00 y00 x10 y10
+        const __m128 b  = _mm_loadu_ps(r1);                    // x01 y01 x11 y11
+        const __m128 v  = _mm_add_ps(a, _mm_mul_ps(_mm_sub_ps(b, a), _mm_set1_ps(ty)));
+        const __m128 hi = _mm_movehl_ps(v, v);                 // x1 y1 x1 y1
+        const __m128 o  = _mm_add_ps(v, _mm_mul_ps(_mm_sub_ps(hi, v), _mm_set1_ps(tx)));
+        *vx = _mm_cvtss_f32(o);
+        *vy = _mm_cvtss_f32(_mm_shuffle_ps(o, o, _MM_SHUFFLE(1, 1, 1, 1)));
+#else
+        const float x0 = r0[0] + (r1[0] - r0[0]) * ty;
+        const float y0 = r0[1] + (r1[1] - r0[1]) * ty;
+        const float x1 = r0[2] + (r1[2] - r0[2]) * ty;
+        const float y1 = r0[3] + (r1[3] - r0[3]) * ty;
+        *vx = x0 + (x1 - x0) * tx;
+        *vy = y0 + (y1 - y0) * tx;
+#endif
+    }
+
+private:
+    void bakeRows(std::vector<float> &grid, int from, int to) const;
+
+    std::vector<float>  m_grids[2];            // preallocate GRID×GRID×2
+    std::vector<float> *m_front = &m_grids[0];
+    std::vector<float> *m_back  = &m_grids[1];
+    int  m_nextRow = 0;                        // prossima riga di m_back
+    bool m_empty   = true;
+
+    int   m_gw = 2, m_gh = 2;
+    float m_invCell = 1.0f;
+    float m_maxX = 0.0f, m_maxY = 0.0f;
+
+    // Parametri del ciclo di bake in corso (fissati alla sua prima riga)
+    float m_w = -1.0f, m_h = -1.0f, m_scale = -1.0f;
+    float m_cell     = 1.0f;
+    float m_bakeTime = 0.0f;
+    float m_rotation = 0.0f;
+    float m_swirl    = 0.0f;
+};
+
+#endif // FLOWFIELD_H
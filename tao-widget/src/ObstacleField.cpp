@@ -0,0 +1,195 @@
+#include "ObstacleField.h"
+#include "ParticleSystem.h"
+
+#include <cmath>
+
+// Lancette come disegnate da TaoNew: lunghezza (× raggio) e mezzo spessore
+// (px, con un pixel di margine)
+static constexpr float HAND_LENGTH[3]     = { 0.5f, 0.8f, 0.9f };
+static constexpr float HAND_HALF_WIDTH[3] = { 3.5f, 2.5f, 1.75f };
+static constexpr float PI = 3.14159265f;
+
+static inline float segmentDistance(float px, float py, float ax, float ay, float bx, float by)
+{
+    const float abx = bx - ax, aby = by - ay;
+    const float apx = px - ax, apy = py - ay;
+    const float len = abx * abx + aby * aby;
+    const float t   = len > 0.0f ? qBound(0.0f, (apx * abx + apy * aby) / len, 1.0f) : 0.0f;
+    const float dx  = apx - abx * t;
+    const float dy  = apy - aby * t;
+    return std::sqrt(dx * dx + dy * dy);
+}
+
+// ═════════════════════════════════════════════════════════════════════════════
+// ObstacleField
+// ═════════════════════════════════════════════════════════════════════════════
+
+ObstacleField::ObstacleField()
+    : m_grid(static_cast<size_t>(GRID) * GRID, 0.0f)
+{
+}
+
+void ObstacleField::gridSize(float w, float h, int *gw, int *gh)
+{
+    const float side = qMax(qMax(w, h), 1.0f);
+    const float cell = side / (GRID - 1);
+    *gw = qBound(2, static_cast<int>(std::ceil(w / cell)) + 1, GRID);
+    *gh = qBound(2, static_cast<int>(std::ceil(h / cell)) + 1, GRID);
+}
+
+void ObstacleField::setMask(std::vector<float> &&distance, int gw, int gh)
+{
+    m_mask      = std::move(distance);
+    m_maskW     = m_mask.empty() ? 0 : gw;
+    m_maskH     = m_mask.empty() ? 0 : gh;
+    m_maskDirty = true;
+}
+
+// ── Transformata di distanza ──────────────────────────────────────────────────
+// Propagazione del nodo-seme più vicino in due passate (avanti/indietro, 8
+// vicini): errore sotto la cella, più che sufficiente per una collisione.
+
+static void propagate(const quint8 *seed, int gw, int gh, float *out)
+{
+    constexpr int NONE = -1;
+    std::vector<int> nearest(static_cast<size_t>(gw) * gh, NONE);
+    for (int i = 0; i < gw * gh; ++i)
+        if (seed[i]) nearest[i] = i;
+
+    const auto dist2 = [gw](int a, int b) {
+        const int dx = a % gw - b % gw;
+        const int dy = a / gw - b / gw;
+        return dx * dx + dy * dy;
+    };
+    const auto relax = [&](int i, int x, int y, int ox, int oy) {
+        const int nx = x + ox, ny = y + oy;
+        if (nx < 0 || ny < 0 || nx >= gw || ny >= gh) return;
+        const int cand = nearest[ny * gw + nx];
+        if (cand == NONE) return;
+        if (nearest[i] == NONE || dist2(i, cand) < dist2(i, nearest[i]))
+            nearest[i] = cand;
+    };
+
+    for (int y = 0; y < gh; ++y)
+        for (int x = 0; x < gw; ++x) {
+            const int i = y * gw + x;
+            relax(i, x, y, -1, -1); relax(i, x, y, 0, -1);
+            relax(i, x, y,  1, -1); relax(i, x, y, -1, 0);
+        }
+    for (int y = gh - 1; y >= 0; --y)
+        for (int x = gw - 1; x >= 0; --x) {
+            const int i = y * gw + x;
+            relax(i, x, y, 1, 1); relax(i, x, y, 0, 1);
+            relax(i, x, y, -1, 1); relax(i, x, y, 1, 0);
+        }
+
+    for (int i = 0; i < gw * gh; ++i)
+        out[i] = nearest[i] == NONE ? static_cast<float>(gw + gh)   // nessun seme: "lontano"
+                                    : std::sqrt(static_cast<float>(dist2(i, nearest[i])));
+}
+
+void ObstacleField::maskDistance(const quint8 *solid, int gw, int gh, float *out)
+{
+    const size_t n = static_cast<size_t>(gw) * gh;
+    std::vector<quint8> empty(n);
+    std::vector<float>  inside(n);
+    for (size_t i = 0; i < n; ++i)
+        empty[i] = solid[i] ? 0 : 1;
+
+    propagate(solid,        gw, gh, out);            // fuori: distanza dal pieno
+    propagate(empty.data(), gw, gh, inside.data());  // dentro: distanza dal vuoto
+
+    // Mezzo passo di griglia tra i due lati del bordo
+    for (size_t i = 0; i < n; ++i)
+        out[i] = solid[i] ? 0.5f - inside[i] : out[i] - 0.5f;
+}
+
+// ── Bake ──────────────────────────────────────────────────────────────────────
+
+bool ObstacleField::needsBake(const SimulationParams &p) const
+{
+    if (p.w != m_w || p.h != m_h || p.obstacleFlags != m_flags || m_maskDirty)
+        return true;
+
+    // Forme in movimento: ribake quando il bordo si è spostato di mezza cella
+    const float r    = qMin(p.w, p.h) / 4.5f;
+    const float half = 0.5f * m_cell;
+    if ((m_flags & ObstacleDots) && std::fabs(p.taoRotation - m_rotation) * r * (0.5f + 1.0f / 6.0f) > half)
+        return true;
+    if (m_flags & ObstacleHands)
+        for (int k = 0; k < 3; ++k) {
+            float delta = std::fabs(p.handAngle[k] - m_hands[k]);
+            if (delta > PI) delta = 2.0f * PI - delta;
+            if (delta * r * HAND_LENGTH[k] > half)
+                return true;
+        }
+    return false;
+}
+
+void ObstacleField::update(const SimulationParams &params)
+{
+    if (needsBake(params))
+        bake(params);
+}
+
+void ObstacleField::bake(const SimulationParams &p)
+{
+    m_w         = p.w;
+    m_h         = p.h;
+    m_flags     = p.obstacleFlags;
+    m_rotation  = p.taoRotation;
+    for (int k = 0; k < 3; ++k) m_hands[k] = p.handAngle[k];
+    m_maskDirty = false;
+
+    gridSize(p.w, p.h, &m_gw, &m_gh);
+    m_cell    = qMax(qMax(p.w, p.h), 1.0f) / (GRID - 1);
+    m_invCell = 1.0f / m_cell;
+    m_maxX    = static_cast<float>(m_gw - 1) - 0.001f;
+    m_maxY    = static_cast<float>(m_gh - 1) - 0.001f;
+
+    const bool useMask = (m_flags & ObstacleMask) && m_maskW == m_gw && m_maskH == m_gh;
+    m_empty = !(m_flags & (ObstacleTao | ObstacleDots | ObstacleHands)) && !useMask;
+    if (m_empty)
+        return;
+
+    const float cx = p.w * 0.5f;
+    const float cy = p.h * 0.5f;
+    const float r  = qMin(p.w, p.h) / 4.5f;
+
+    // Puntini: (0, ∓r/2) nel riferimento del Tao, ruotati come m_taoRotNode
+    const float s = std::sin(p.taoRotation);
+    const float c = std::cos(p.taoRotation);
+    const float dotX[2] = { cx + 0.5f * r * s, cx - 0.5f * r * s };
+    const float dotY[2] = { cy - 0.5f * r * c, cy + 0.5f * r * c };
+    const float dotR    = r / 6.0f;
+    // Valore finito per "nessun ostacolo": la bilineare non deve vedere inf
+    const float far     = 2.0f * (p.w + p.h) + 1.0f;
+
+    float handX[3], handY[3];
+    for (int k = 0; k < 3; ++k) {
+        handX[k] = cx + std::cos(p.handAngle[k]) * r * HAND_LENGTH[k];
+        handY[k] = cy + std::sin(p.handAngle[k]) * r * HAND_LENGTH[k];
+    }
+
+    for (int j = 0; j < m_gh; ++j) {
+        const float py = j * m_cell;
+        float *row = m_grid.data() + j * m_gw;
+        for (int i = 0; i < m_gw; ++i) {
+            const float px = i * m_cell;
+            float d = far;
+
+            if (m_flags & ObstacleTao)
+                d = qMin(d, std::hypot(px - cx, py - cy) - r);
+            if (m_flags & ObstacleDots)
+                for (int k = 0; k < 2; ++k)
+                    d = qMin(d, std::hypot(px - dotX[k], py - dotY[k]) - dotR);
+            if (m_flags & ObstacleHands)
+                for (int k = 0; k < 3; ++k)
+                    d = qMin(d, segmentDistance(px, py, cx, cy, handX[k], handY[k]) - HAND_HALF_WIDTH[k]);
+            if (useMask)
+                d = qMin(d, m_mask[static_cast<size_t>(j) * m_gw + i] * m_cell);
+
+            row[i] = d;
+        }
+    }
+}
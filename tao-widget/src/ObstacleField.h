@@ -0,0 +1,95 @@
+#ifndef OBSTACLEFIELD_H
+#define OBSTACLEFIELD_H
+
+#include <QtGlobal>
+#include <vector>
+
+struct SimulationParams;
+
+// ── Forme ostacolo (bit di SimulationParams::obstacleFlags) ───────────────────
+
+enum ObstacleShape : quint32 {
+    ObstacleTao   = 1,   // disco del Tao
+    ObstacleDots  = 2,   // i due puntini interni (ruotano con il Tao)
+    ObstacleHands = 4,   // lancette dell'orologio
+    ObstacleMask  = 8,   // maschera utente (immagine/SVG) stesa sull'item
+};
+
+// ── ObstacleField ─────────────────────────────────────────────────────────────
+// Campo di distanza con segno (negativo dentro gli ostacoli) campionato su una
+// griglia di al più GRID×GRID nodi, in coordinate item. Il kernel fa una sola
+// lettura bilineare (+ gradiente) per particella, qualunque sia la scena.
+// Il ribake avviene sul worker, solo quando cambiano forme o dimensione o
+// quando una forma in movimento si è spostata di mezza cella.
+
+class ObstacleField
+{
+public:
+    static constexpr int GRID = 96;
+
+    ObstacleField();
+
+    // Dimensioni della griglia per un item w×h (celle quadrate)
+    static void gridSize(float w, float h, int *gw, int *gh);
+
+    // Distanza con segno, in celle, da una maschera binaria gw×gh
+    // (solid ≠ 0 = ostacolo). Transformata a due passate, O(gw·gh).
+    static void maskDistance(const quint8 *solid, int gw, int gh, float *out);
+
+    // Maschera già convertita da maskDistance(); vuota = nessuna maschera.
+    // Da chiamare a worker fermo.
+    void setMask(std::vector<float> &&distance, int gw, int gh);
+
+    void update(const SimulationParams &params);
+
+    // Scarta il bake corrente: il prossimo update() ricostruisce il campo
+    // (la maschera resta). Per ParticleSystem::reset().
+    void invalidate() { m_w = m_h = -1.0f; }
+
+    bool isEmpty() const { return m_empty; }
+
+    // Distanza (px) e gradiente in (x, y)
+    float sample(float x, float y, float *gx, float *gy) const
+    {
+        float fx = x * m_invCell;
+        float fy = y * m_invCell;
+        fx = qBound(0.0f, fx, m_maxX);
+        fy = qBound(0.0f, fy, m_maxY);
+        const int   ix = static_cast<int>(fx);
+        const int   iy = static_cast<int>(fy);
+        const float tx = fx - ix;
+        const float ty = fy - iy;
+
+        const float *r0 = m_grid.data() + iy * m_gw + ix;
+        const float *r1 = r0 + m_gw;
+        const float top = r0[0] + (r0[1] - r0[0]) * tx;
+        const float bot = r1[0] + (r1[1] - r1[0]) * tx;
+
+        *gx = ((r0[1] - r0[0]) * (1.0f - ty) + (r1[1] - r1[0]) * ty) * m_invCell;
+        *gy = (bot - top) * m_invCell;
+        return top + (bot - top) * ty;
+    }
+
+private:
+    bool needsBake(const SimulationParams &params) const;
+    void bake(const SimulationParams &params);
+
+    std::vector<float> m_grid;      // preallocata GRID×GRID
+    std::vector<float> m_mask;
+    int   m_maskW = 0, m_maskH = 0;
+
+    int   m_gw = 2, m_gh = 2;
+    float m_cell    = 1.0f;
+    float m_invCell = 1.0f;
+    float m_maxX = 0.0f, m_maxY = 0.0f;   // ultimo indice campionabile (esclusivo)
+    bool  m_empty = true;
+
+    // Chiave dell'ultimo bake
+    float   m_w = -1.0f, m_h = -1.0f;
+    quint32 m_flags    = 0;
+    float   m_rotation = 0.0f;
+    float   m_hands[3] = { 0.0f, 0.0f, 0.0f };
+    bool    m_maskDirty = false;
+};
+
+#endif // OBSTACLEFIELD_H
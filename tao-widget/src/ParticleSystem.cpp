@@ -0,0 +1,258 @@
+#include "ParticleSystem.h"
+
+#include <QRandomGenerator>
+#include <cmath>
+#include <cstring>
+
+// Premoltiplica l'alpha e impacchetta RGBA in un quint32 (formato GPU).
+static inline quint32 packColor(unsigned char r, unsigned char g,
+                                unsigned char b, unsigned char a)
+{
+    const float af = a / 255.0f;
+    const auto pr  = static_cast<unsigned char>(r * af);
+    const auto pg  = static_cast<unsigned char>(g * af);
+    const auto pb  = static_cast<unsigned char>(b * af);
+    return (quint32(a) << 24) | (quint32(pb) << 16) | (quint32(pg) << 8) | quint32(pr);
+}
+
+// ═════════════════════════════════════════════════════════════════════════════
+// ParticleSystem
+// ═════════════════════════════════════════════════════════════════════════════
+
+ParticleSystem::ParticleSystem(int capacity)
+    : m_particles(static_cast<size_t>(qMax(0, capacity)))
+{
+    std::memset(m_particles.data(), 0, sizeof(ParticleData) * m_particles.size());
+    // Seed casuale di default; reset() lo rende riproducibile
+    m_rng.state = QRandomGenerator::global()->generate64();
+}
+
+void ParticleSystem::reset(quint64 seed)
+{
+    m_liveCount        = 0;
+    m_lastBurstEmitted = 0;
+    m_spawnCounter     = 0;
+    m_time             = 0.0;
+    m_rng.state        = seed;
+    std::memset(m_particles.data(), 0, sizeof(ParticleData) * m_particles.size());
+
+    // Nessuno stato dei campi sopravvive al reset: un replay sullo stesso
+    // sistema deve ripartire identico a uno su un sistema nuovo
+    m_obstacles.invalidate();
+    m_flow.reset();
+}
+
+void ParticleSystem::clear(ParticleVertex *out)
+{
+    for (int i = 0; i < m_visibleCount; ++i)
+        out[i].size = 0.0f;
+    m_visibleCount = 0;
+    m_liveCount    = 0;
+}
+
+// ═════════════════════════════════════════════════════════════════════════════
+// step
+// ═════════════════════════════════════════════════════════════════════════════
+
+int ParticleSystem::step(const SimulationParams &params, ParticleVertex *out)
+{
+    const float w   = params.w;
+    const float h   = params.h;
+    const float cx  = w * 0.5f;
+    const float cy  = h * 0.5f;
+    const float r   = qMin(w, h) / 4.5f;
+    const float df  = params.dt * 60.0f;
+
+    // Ribake del campo ostacoli solo se forme/dimensione/posa sono cambiate
+    m_obstacles.update(params);
+    const bool obstacles = !m_obstacles.isEmpty();
+
+    // Flusso: qualche riga della griglia successiva per step, nessun
+    // rumore valutato per particella
+    m_time += params.dt;
+    m_flow.update(params, static_cast<float>(m_time));
+    const bool  flow  = !m_flow.isEmpty();
+    const float flowK = params.flowStrength;
+
+    // Friction pre-calcolata fuori dal loop
+    const float friction = std::pow(0.98f, df);
+
+    const int    nAttractors = qBound(0, params.attractorCount, SimulationParams::MAX_ATTRACTORS);
+    const float *ax = params.attractorX;
+    const float *ay = params.attractorY;
+
+    // Canali colore estratti una volta per tutte
+    const quint8 pc1r = params.color1[0], pc1g = params.color1[1], pc1b = params.color1[2];
+    const quint8 pc2r = params.color2[0], pc2g = params.color2[1], pc2b = params.color2[2];
+
+    const float dpr       = params.spriteScale;
+    const float pSize     = params.size;
+    const float pSizeRand = params.sizeRandom;
+    const int   count     = params.count;
+    const int   budget    = params.budget;
+    const int   capacity  = this->capacity();
+
+    ParticleData   *pData = m_particles.data();
+    ParticleVertex *vData = out;
+
+    // ── 1. Integrazione sul prefisso vivo [0, live) ────────────────────
+    // Una particella che muore viene sostituita dall'ultima viva
+    // (swap-remove): il range resta denso e nessuno slot morto costa
+    // un branch o una cache line.
+    int live = m_liveCount;
+    int i    = 0;
+    while (i < live)
+    {
+        ParticleData &p = pData[i];
+
+        // ── Attrattori (mouse / tocchi) ────────────────────────────────
+        // Le forze si sommano; l'attrito vale solo fuori da ogni raggio.
+        bool attracted = false;
+        for (int a = 0; a < nAttractors; ++a) {
+            const float dx = ax[a] - p.x;
+            const float dy = ay[a] - p.y;
+            if (qAbs(dx) < 300.0f && qAbs(dy) < 300.0f) {
+                const float distSq = dx*dx + dy*dy;
+                if (distSq < 90000.0f) {
+                    const float f = 3.5f / (distSq + 100.0f);
+                    p.vx += dx * f * df;
+                    p.vy += dy * f * df;
+                    attracted = true;
+                }
+            }
+        }
+        if (!attracted) {
+            p.vx *= friction;
+            p.vy *= friction;
+        }
+
+        // ── Integrazione posizione ─────────────────────────────────────
+        // Il flusso trasporta la particella senza entrare nella sua
+        // velocità: attrito e attrattori restano quelli di sempre.
+        float ux = p.vx, uy = p.vy;
+        if (flow) {
+            float fx, fy;
+            m_flow.sample(p.x, p.y, &fx, &fy);
+            ux += fx * flowK;
+            uy += fy * flowK;
+        }
+        p.x += ux * df;
+        p.y += uy * df;
+
+        // Rimbalzo sui bordi
+        if      (p.x < 0) { p.x = 0; p.vx =  qAbs(p.vx) * 0.4f; }
+        else if (p.x > w) { p.x = w; p.vx = -qAbs(p.vx) * 0.4f; }
+        if      (p.y < 0) { p.y = 0; p.vy =  qAbs(p.vy) * 0.4f; }
+        else if (p.y > h) { p.y = h; p.vy = -qAbs(p.vy) * 0.4f; }
+
+        // ── Collisione con gli ostacoli (SDF) ──────────────────────────
+        // Una lettura bilineare + gradiente, qualunque sia la scena.
+        if (obstacles) {
+            float gx, gy;
+            const float d = m_obstacles.sample(p.x, p.y, &gx, &gy);
+            if (d < 0.0f) {
+                const float gLenSq = gx*gx + gy*gy;
+                if (gLenSq > 1e-8f) {
+                    const float inv  = 1.0f / std::sqrt(gLenSq);
+                    const float nx   = gx * inv;
+                    const float ny   = gy * inv;
+                    const float push = -d * 0.3f;
+                    p.x += nx * push;
+                    p.y += ny * push;
+                    const float dot = p.vx * nx + p.vy * ny;
+                    if (dot < 0) {
+                        p.vx -= 1.6f * dot * nx;
+                        p.vy -= 1.6f * dot * ny;
+                    }
+                }
+            }
+        }
+
+        // ── Aging ──────────────────────────────────────────────────────
+        p.life -= p.decay * df;
+        if (p.life <= 0.0f) {
+            p = pData[--live];   // l'ultima viva (non ancora integrata) prende lo slot i
+            continue;
+        }
+
+        // ── Colore ─────────────────────────────────────────────────────
+        const auto alpha = static_cast<unsigned char>(p.life * 255.0f * 0.85f);
+        unsigned char red, green, blue;
+
+        if (p.variant != 0) {
+            // Colore secondario: variazione in base alla vita residua
+            red   = pc2r;
+            green = static_cast<unsigned char>(qMin(255, (int)pc2g + (int)(p.life * 50)));
+            blue  = pc2b;
+        } else {
+            // Colore primario: shift warm in base alla velocità
+            const float speedSq = p.vx*p.vx + p.vy*p.vy;
+            red   = static_cast<unsigned char>(qMin(255.0f, (float)pc1r + speedSq * 8.0f));
+            green = static_cast<unsigned char>(qMin(255.0f, (float)pc1g + speedSq * 4.0f));
+            blue  = pc1b;
+        }
+
+        ParticleVertex &v = vData[i];
+        v.x     = p.x;
+        v.y     = p.y;
+        v.size  = p.size * dpr;   // scala per HiDPI/Retina e LOD
+        v.color = packColor(red, green, blue, alpha);
+        ++i;
+    }
+
+    // ── 2. Emissione (passata separata, a budget) ──────────────────────
+    // I burst hanno precedenza e possono superare `count` fino a
+    // capacity(); il riempimento regolare porta il pool a `count`.
+    // Entrambi condividono il budget per frame: niente picchi.
+    const int nBurst      = qMin(qMin(params.burstCount, budget), capacity - live);
+    const int nRegular    = qMax(0, qMin(budget - nBurst, count - (live + nBurst)));
+    m_lastBurstEmitted    = qMax(0, nBurst);
+
+    const auto spawn = [&](ParticleData &p, ParticleVertex &v, float ox, float oy,
+                           double minDist, double distRange) {
+        p.life = 1.0f;
+        const double angle = m_rng.nextDouble() * 6.28318;
+        const double dist  = minDist + m_rng.nextDouble() * distRange;
+        p.x  = ox + static_cast<float>(std::cos(angle) * dist);
+        p.y  = oy + static_cast<float>(std::sin(angle) * dist);
+        p.vx = static_cast<float>((m_rng.nextDouble() - 0.5) * 0.6);
+        p.vy = static_cast<float>((m_rng.nextDouble() - 0.5) * 0.6);
+
+        // Sposta fuori dagli ostacoli se ci è finita dentro
+        if (obstacles) {
+            float gx, gy;
+            const float d = m_obstacles.sample(p.x, p.y, &gx, &gy);
+            const float gLenSq = gx*gx + gy*gy;
+            if (d < 0.0f && gLenSq > 1e-8f) {
+                const float k = -d / std::sqrt(gLenSq);
+                p.x += gx * k;
+                p.y += gy * k;
+            }
+        }
+
+        p.decay   = 0.003f + static_cast<float>(m_rng.nextDouble()) * 0.008f;
+        // Raggio personalizzabile
+        p.size    = pSize + static_cast<float>(m_rng.nextDouble()) * pSizeRand;
+        // Una particella su sette usa il colore secondario
+        p.variant = (m_spawnCounter++ % 7 == 0) ? 1u : 0u;
+
+        // Frame invisibile per la nascita: evita pop visivi
+        v.x = p.x; v.y = p.y; v.size = 0.0f;
+        v.color = packColor(pc1r, pc1g, pc1b, static_cast<unsigned char>(255 * 0.85f));
+    };
+
+    const float bx = params.burstX;
+    const float by = params.burstY;
+    for (int n = 0; n < m_lastBurstEmitted; ++n, ++live)
+        spawn(pData[live], vData[live], bx, by, 0.0, r * 0.5);
+    for (int n = 0; n < nRegular; ++n, ++live)
+        spawn(pData[live], vData[live], cx, cy, r * 0.5, r * 2.0);
+
+    // ── 3. Coda: nasconde solo gli slot che al frame scorso erano visibili
+    for (int k = live; k < m_visibleCount; ++k)
+        vData[k].size = 0.0f;
+    m_visibleCount = live;
+    m_liveCount    = live;
+
+    return live;
+}
@@ -0,0 +1,125 @@
+#ifndef PARTICLESYSTEM_H
+#define PARTICLESYSTEM_H
+
+#include "FlowField.h"
+#include "ObstacleField.h"
+
+#include <QtGlobal>
+#include <vector>
+
+// ── Strutture dati particelle ─────────────────────────────────────────────────
+
+struct ParticleData {
+    float   x, y;
+    float   vx, vy;
+    float   life;
+    float   decay;
+    float   size;
+    quint32 variant;   // 0 = colore primario, 1 = secondario (assegnato alla nascita)
+};
+
+struct ParticleVertex {
+    float   x, y;
+    float   size;
+    quint32 color;
+};
+
+// ── TaoRng ────────────────────────────────────────────────────────────────────
+// SplitMix64: stessa sequenza su ogni piattaforma a parità di seed, nessun
+// lock e nessuno stato condiviso (a differenza di QRandomGenerator::global()).
+
+struct TaoRng {
+    quint64 state = 0;
+
+    quint64 next()
+    {
+        quint64 z = (state += 0x9E3779B97F4A7C15ull);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+        return z ^ (z >> 31);
+    }
+
+    // [0, 1) con 53 bit di mantissa
+    double nextDouble() { return static_cast<double>(next() >> 11) * (1.0 / 9007199254740992.0); }
+};
+
+// ── SimulationParams ──────────────────────────────────────────────────────────
+// Tutto l'input di uno step: snapshot preso sul GUI/render thread, registrabile
+// e riproducibile (vedi TaoReplay.h). Nessun puntatore, nessun tipo Qt GUI.
+
+struct SimulationParams {
+    static constexpr int MAX_ATTRACTORS = 5;
+
+    float  w = 0.0f, h = 0.0f;
+    float  dt = 0.016f;
+
+    // Attrattori: cursore in hover e punti di tocco, già filtrati sull'item
+    int    attractorCount = 0;
+    float  attractorX[MAX_ATTRACTORS] = {};
+    float  attractorY[MAX_ATTRACTORS] = {};
+
+    int    count  = 0;          // popolazione obiettivo (già scalata dal LOD)
+    int    budget = 1;          // nascite massime per step
+    int    burstCount = 0;      // burst in attesa
+    float  burstX = 0.0f, burstY = 0.0f;
+
+    // Ostacoli (vedi ObstacleField): forme attive e posa di quelle in movimento
+    quint32 obstacleFlags = ObstacleTao;
+    float   taoRotation   = 0.0f;                 // rad
+    float   handAngle[3]  = { 0.0f, 0.0f, 0.0f }; // rad nel riferimento item (ore, min, sec)
+
+    // Flusso ambientale (vedi FlowField): 0 = spento
+    float   flowStrength = 0.0f;   // px/frame a 60 Hz per unità di campo
+    float   flowScale    = 0.35f;  // dimensione dei vortici (× lato minore)
+    float   flowSwirl    = 0.0f;   // vortice attorno al Tao, > 0 orario
+
+    quint8 color1[3] = { 0, 0, 0 };
+    quint8 color2[3] = { 0, 0, 0 };
+    float  size        = 4.0f;
+    float  sizeRandom  = 8.0f;
+    float  spriteScale = 1.0f;  // DPR × LOD
+};
+
+// ── ParticleSystem ────────────────────────────────────────────────────────────
+// Kernel di simulazione indipendente da Qt Quick: usato dal worker di TaoNew
+// e dallo strumento headless tao-replay.
+
+class ParticleSystem
+{
+public:
+    explicit ParticleSystem(int capacity);
+
+    // Svuota il pool e riparte da una sequenza casuale nota
+    void reset(quint64 seed);
+
+    // Uno step completo (integrazione + emissione). Scrive i vertici del
+    // prefisso vivo in `out` (capacità ≥ capacity()) e azzera gli slot spenti.
+    // Ritorna il numero di particelle vive.
+    int  step(const SimulationParams &params, ParticleVertex *out);
+
+    // Nasconde tutte le particelle visibili in `out` e svuota il pool
+    void clear(ParticleVertex *out);
+
+    int                 capacity()      const { return static_cast<int>(m_particles.size()); }
+    int                 liveCount()     const { return m_liveCount; }
+    int                 lastBurstEmitted() const { return m_lastBurstEmitted; }
+    const ParticleData *particles()     const { return m_particles.data(); }
+
+    // Per setMask(): solo a step fermo
+    ObstacleField      &obstacles()           { return m_obstacles; }
+
+private:
+    std::vector<ParticleData> m_particles;
+    ObstacleField             m_obstacles;
+    FlowField                 m_flow;
+
+    // Pool partizionato: [0, m_liveCount) vive, il resto libero.
+    int     m_liveCount        = 0;
+    int     m_visibleCount     = 0;   // slot con size≠0 nel buffer vertici
+    int     m_lastBurstEmitted = 0;
+    quint32 m_spawnCounter     = 0;
+    double  m_time             = 0.0; // tempo di simulazione (s), per il flusso
+    TaoRng  m_rng;
+};
+
+#endif // PARTICLESYSTEM_H
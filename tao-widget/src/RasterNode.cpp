@@ -0,0 +1,119 @@
+#include "RasterNode.h"
+#include "SoftwareRaster.h"
+#include "TaoTrace.h"
+
+#include <QPainter>
+#include <QQuickWindow>
+#include <QSGRendererInterface>
+
+// ═════════════════════════════════════════════════════════════════════════════
+// RasterTexture
+// ═════════════════════════════════════════════════════════════════════════════
+
+RasterTexture::RasterTexture(const SoftwareRaster &raster)
+    : m_raster(raster)
+{
+}
+
+RasterTexture::~RasterTexture()
+{
+    delete m_texture;
+}
+
+qint64 RasterTexture::comparisonKey() const
+{
+    return static_cast<qint64>(reinterpret_cast<quintptr>(this));
+}
+
+QSize RasterTexture::textureSize() const
+{
+    return m_raster.size();
+}
+
+void RasterTexture::commitTextureOperations(QRhi *rhi, QRhiResourceUpdateBatch *updates)
+{
+    const QImage &image = m_raster.image();
+    if (image.isNull())
+        return;
+
+    // ARGB32 premoltiplicato in memoria è BGRA: caricato così com'è dove il
+    // formato è supportato, altrimenti scambiando R e B riga per riga
+    const bool bgra = rhi->isTextureFormatSupported(QRhiTexture::BGRA8);
+    if (!m_texture || m_texture->pixelSize() != image.size()) {
+        if (!m_texture)
+            m_texture = rhi->newTexture(bgra ? QRhiTexture::BGRA8 : QRhiTexture::RGBA8, image.size());
+        else
+            m_texture->setPixelSize(image.size());
+        if (!m_texture->create()) {
+            // Nessuna texture valida da esporre né su cui caricare: si
+            // riprova la creazione al prossimo commit
+            delete m_texture;
+            m_texture = nullptr;
+            return;
+        }
+        m_swizzled = bgra ? QImage() : QImage(image.size(), QImage::Format_RGBA8888_Premultiplied);
+        m_dirty    = image.rect();
+    }
+
+    const QRect rect = m_dirty & image.rect();
+    m_dirty = QRect();
+    if (rect.isEmpty())
+        return;
+
+    TraceSpan span("raster upload");
+    QImage source;
+    if (bgra) {
+        // Vista senza proprietà sui pixel del raster: nessun riferimento
+        // condiviso, il prossimo render() scrive nell'immagine senza detach.
+        // I dati vengono letti prima della fine del frame.
+        source = QImage(image.constBits(), image.width(), image.height(),
+                        image.bytesPerLine(), image.format());
+    } else {
+        for (int y = rect.top(); y <= rect.bottom(); ++y) {
+            const quint32 *in  = reinterpret_cast<const quint32 *>(image.constScanLine(y)) + rect.left();
+            quint32       *out = reinterpret_cast<quint32 *>(m_swizzled.scanLine(y)) + rect.left();
+            for (int x = 0; x < rect.width(); ++x) {
+                const quint32 p = in[x];   // 0xAARRGGBB → byte R, G, B, A
+                out[x] = (p & 0xFF00FF00u) | ((p >> 16) & 0xFFu) | ((p & 0xFFu) << 16);
+            }
+        }
+        source = QImage(m_swizzled.constBits(), m_swizzled.width(), m_swizzled.height(),
+                        m_swizzled.bytesPerLine(), m_swizzled.format());
+    }
+
+    QRhiTextureSubresourceUploadDescription sub(source);
+    sub.setSourceTopLeft(rect.topLeft());
+    sub.setSourceSize(rect.size());
+    sub.setDestinationTopLeft(rect.topLeft());
+    updates->uploadTexture(m_texture, QRhiTextureUploadDescription(QRhiTextureUploadEntry(0, 0, sub)));
+}
+
+// ═════════════════════════════════════════════════════════════════════════════
+// RasterPaintNode
+// ═════════════════════════════════════════════════════════════════════════════
+
+RasterPaintNode::RasterPaintNode(QQuickWindow *window, const SoftwareRaster &raster)
+    : m_window(window)
+    , m_raster(raster)
+{
+}
+
+void RasterPaintNode::render(const RenderState *state)
+{
+    QSGRendererInterface *ri = m_window->rendererInterface();
+    auto *painter = static_cast<QPainter *>(
+        ri->getResource(m_window, QSGRendererInterface::PainterResource));
+    const QImage &image = m_raster.image();
+    if (!painter || image.isNull())
+        return;
+
+    // La clip va impostata prima della trasformazione (è già in coordinate
+    // finestra)
+    const QRegion *clip = state->clipRegion();
+    if (clip && !clip->isEmpty())
+        painter->setClipRegion(*clip, Qt::ReplaceClip);
+    painter->setTransform(matrix()->toTransform());
+    painter->setOpacity(inheritedOpacity());
+    painter->setRenderHint(QPainter::SmoothPixmapTransform, false);
+    painter->drawImage(m_rect, image);
+}
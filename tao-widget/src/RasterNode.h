@@ -0,0 +1,68 @@
+#ifndef RASTERNODE_H
+#define RASTERNODE_H
+
+#include <QImage>
+#include <QRect>
+#include <QRectF>
+#include <QSGRenderNode>
+#include <QSGTexture>
+#include <rhi/qrhi.h>
+
+class QQuickWindow;
+class SoftwareRaster;
+
+// ── RasterTexture ─────────────────────────────────────────────────────────────
+// Texture persistente con l'immagine di SoftwareRaster, per le finestre con
+// QRhi (modalità software forzata): la QRhiTexture viene creata una volta per
+// dimensione e a ogni frame riceve solo il rettangolo ridisegnato. I pixel
+// passano da una QImage che non possiede i dati, quindi il raster riscrive
+// la propria immagine al frame successivo senza detach.
+
+class RasterTexture : public QSGTexture
+{
+public:
+    explicit RasterTexture(const SoftwareRaster &raster);
+    ~RasterTexture() override;
+
+    // Render thread (updatePaintNode): area da caricare al prossimo commit
+    void addDirtyRect(const QRect &rect) { m_dirty |= rect; }
+
+    qint64       comparisonKey() const override;
+    QRhiTexture *rhiTexture() const override { return m_texture; }
+    QSize        textureSize() const override;
+    bool         hasAlphaChannel() const override { return true; }
+    bool         hasMipmaps() const override { return false; }
+    void         commitTextureOperations(QRhi *rhi, QRhiResourceUpdateBatch *updates) override;
+
+private:
+    const SoftwareRaster &m_raster;
+    QRhiTexture          *m_texture = nullptr;
+    QRect                 m_dirty;
+    QImage                m_swizzled;   // solo senza BGRA8: RGBA dei rettangoli sporchi
+};
+
+// ── RasterPaintNode ───────────────────────────────────────────────────────────
+// Scene graph software (nessun QRhi, nessuna texture): l'immagine del raster
+// viene disegnata con il QPainter del renderer, senza conversione in pixmap
+// né copie. Il renderer limita il disegno alla propria regione sporca.
+
+class RasterPaintNode : public QSGRenderNode
+{
+public:
+    RasterPaintNode(QQuickWindow *window, const SoftwareRaster &raster);
+
+    // Rettangolo in coordinate item su cui stendere l'immagine
+    void setRect(const QRectF &rect) { m_rect = rect; }
+
+    void           render(const RenderState *state) override;
+    StateFlags     changedStates() const override { return {}; }
+    RenderingFlags flags() const override { return BoundedRectRendering; }
+    QRectF         rect() const override { return m_rect; }
+
+private:
+    QQuickWindow         *m_window;
+    const SoftwareRaster &m_raster;
+    QRectF                m_rect;
+};
+
+#endif // RASTERNODE_H
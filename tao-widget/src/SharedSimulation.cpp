@@ -0,0 +1,304 @@
+#include "SharedSimulation.h"
+#include "TaoTrace.h"
+
+#include <QHash>
+#include <QLoggingCategory>
+#include <QSocketNotifier>
+#include <cmath>
+#include <cstring>
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+// ═════════════════════════════════════════════════════════════════════════════
+// ParticleBins
+// ═════════════════════════════════════════════════════════════════════════════
+
+ParticleBins::ParticleBins(int capacity)
+    : m_sorted(static_cast<size_t>(qMax(0, capacity)))
+    , m_start(static_cast<size_t>(MAX_BINS) * MAX_BINS + 1, 0)
+    , m_cursor(static_cast<size_t>(MAX_BINS) * MAX_BINS, 0)
+{
+}
+
+void ParticleBins::build(const ParticleVertex *in, int count, float w, float h)
+{
+    m_cell  = qMax(MIN_CELL, qMax(w, h) / MAX_BINS);
+    m_binsX = qBound(1, static_cast<int>(std::ceil(w / m_cell)), MAX_BINS);
+    m_binsY = qBound(1, static_cast<int>(std::ceil(h / m_cell)), MAX_BINS);
+
+    const int   bins = m_binsX * m_binsY;
+    const float inv  = 1.0f / m_cell;
+    count = qMin(count, static_cast<int>(m_sorted.size()));
+
+    const auto binOf = [&](const ParticleVertex &v) {
+        const int bx = qBound(0, static_cast<int>(v.x * inv), m_binsX - 1);
+        const int by = qBound(0, static_cast<int>(v.y * inv), m_binsY - 1);
+        return by * m_binsX + bx;
+    };
+
+    // Counting sort: istogramma, somme prefisse, scatter. Gli slot appena
+    // nati (size = 0) non sono visibili e restano fuori.
+    std::memset(m_start.data(), 0, sizeof(int) * (bins + 1));
+    for (int i = 0; i < count; ++i)
+        if (in[i].size > 0.0f)
+            ++m_start[binOf(in[i]) + 1];
+    for (int b = 0; b < bins; ++b)
+        m_start[b + 1] += m_start[b];
+
+    std::memcpy(m_cursor.data(), m_start.data(), sizeof(int) * bins);
+    for (int i = 0; i < count; ++i)
+        if (in[i].size > 0.0f)
+            m_sorted[m_cursor[binOf(in[i])]++] = in[i];
+    m_count = m_start[bins];
+}
+
+int ParticleBins::cull(const QRectF &rect, float margin, float sizeScale, ParticleVertex *out) const
+{
+    const float x0 = static_cast<float>(rect.left())   - margin;
+    const float y0 = static_cast<float>(rect.top())    - margin;
+    const float x1 = static_cast<float>(rect.right())  + margin;
+    const float y1 = static_cast<float>(rect.bottom()) + margin;
+    if (m_count == 0 || x1 < 0.0f || y1 < 0.0f
+        || x0 > m_binsX * m_cell || y0 > m_binsY * m_cell)
+        return 0;
+
+    const float inv = 1.0f / m_cell;
+    const int bx0 = qBound(0, static_cast<int>(x0 * inv), m_binsX - 1);
+    const int bx1 = qBound(0, static_cast<int>(x1 * inv), m_binsX - 1);
+    const int by0 = qBound(0, static_cast<int>(y0 * inv), m_binsY - 1);
+    const int by1 = qBound(0, static_cast<int>(y1 * inv), m_binsY - 1);
+
+    const float ox = static_cast<float>(rect.left());
+    const float oy = static_cast<float>(rect.top());
+    int n = 0;
+    for (int by = by0; by <= by1; ++by) {
+        // Celle bx0..bx1 della riga: un solo intervallo contiguo
+        const int from = m_start[by * m_binsX + bx0];
+        const int to   = m_start[by * m_binsX + bx1 + 1];
+        for (int i = from; i < to; ++i, ++n) {
+            out[n]       = m_sorted[i];
+            out[n].x    -= ox;
+            out[n].y    -= oy;
+            out[n].size *= sizeScale;
+        }
+    }
+    return n;
+}
+
+// ═════════════════════════════════════════════════════════════════════════════
+// SharedSimulation — registro per gruppo (GUI thread)
+// ═════════════════════════════════════════════════════════════════════════════
+
+static QHash<QString, std::weak_ptr<SharedSimulation>> &registry()
+{
+    static QHash<QString, std::weak_ptr<SharedSimulation>> groups;
+    return groups;
+}
+
+std::shared_ptr<SharedSimulation> SharedSimulation::acquire(const QString &group, int capacity)
+{
+    std::shared_ptr<SharedSimulation> sim = registry().value(group).lock();
+    if (!sim) {
+        sim.reset(new SharedSimulation(group, capacity));
+        registry().insert(group, sim);
+    }
+    return sim;
+}
+
+SharedSimulation::SharedSimulation(const QString &group, int capacity)
+    : m_group(group)
+    , m_system(capacity)
+    , m_stepOut(static_cast<size_t>(qMax(0, capacity)))
+    , m_bins{ ParticleBins(capacity), ParticleBins(capacity) }
+    , m_job(*this, m_system, m_stepOut.data())
+{
+    std::memset(m_stepOut.data(), 0, sizeof(ParticleVertex) * m_stepOut.size());
+
+    m_job.notifyFd = ::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (m_job.notifyFd >= 0) {
+        m_notifier = new QSocketNotifier(m_job.notifyFd, QSocketNotifier::Read, this);
+        connect(m_notifier, &QSocketNotifier::activated, this, &SharedSimulation::onNotify);
+    } else {
+        qCWarning(lcTao) << "eventfd failed, shared simulation" << group << "disabled";
+    }
+    m_clock.start();
+}
+
+SharedSimulation::~SharedSimulation()
+{
+    SimulationWorker::instance().wait(&m_job);
+    delete m_notifier;
+    if (m_job.notifyFd >= 0)
+        ::close(m_job.notifyFd);
+
+    // Il weak_ptr del gruppo è già scaduto: via dal registro
+    const auto it = registry().constFind(m_group);
+    if (it != registry().cend() && it->expired())
+        registry().erase(it);
+}
+
+// ═════════════════════════════════════════════════════════════════════════════
+// Viste
+// ═════════════════════════════════════════════════════════════════════════════
+
+void SharedSimulation::setView(const void *owner, const QRectF &viewport,
+                               const QPointF *attractors, int attractorCount)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    View *slot = nullptr;
+    for (View &v : m_views) {
+        if (v.owner == owner) { slot = &v; break; }
+        if (!slot && !v.owner) slot = &v;
+    }
+    if (!slot) {
+        qCWarning(lcTao) << "shared simulation" << m_group << "supports at most" << MAX_VIEWS << "views";
+        return;
+    }
+
+    slot->owner = owner;
+    slot->rect  = viewport;
+    slot->attractorCount = qBound(0, attractorCount, SimulationParams::MAX_ATTRACTORS);
+    for (int a = 0; a < slot->attractorCount; ++a)
+        slot->attractors[a] = attractors[a];
+}
+
+void SharedSimulation::removeView(const void *owner)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for (View &v : m_views)
+        if (v.owner == owner)
+            v = View();
+}
+
+static QRectF unitedViews(const QRectF &acc, const QRectF &r)
+{
+    return acc.isNull() ? r : acc.united(r);
+}
+
+QRectF SharedSimulation::bounds() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    QRectF united;
+    for (const View &v : m_views)
+        if (v.owner && !v.rect.isEmpty())
+            united = unitedViews(united, v.rect);
+    return united;
+}
+
+// ═════════════════════════════════════════════════════════════════════════════
+// Step
+// ═════════════════════════════════════════════════════════════════════════════
+
+bool SharedSimulation::advance(SimulationParams params, float rotationRate)
+{
+    if (!m_notifier)
+        return false;
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_job.busy())
+        return false;
+
+    const qint64 now = m_clock.elapsed();
+    if (m_lastStep >= 0 && now - m_lastStep < MIN_STEP_MSEC)
+        return false;
+
+    QRectF space;
+    for (const View &v : m_views)
+        if (v.owner && !v.rect.isEmpty())
+            space = unitedViews(space, v.rect);
+    if (space.isEmpty())
+        return false;
+
+    // Tempo proprio della simulazione: non dipende da quale item la avanza
+    const float dt = m_lastStep >= 0 ? qBound(0.001f, (now - m_lastStep) / 1000.0f, 0.1f) : 0.016f;
+    m_lastStep  = now;
+    m_rotation += rotationRate * dt;
+
+    const float ox = static_cast<float>(space.left());
+    const float oy = static_cast<float>(space.top());
+    params.w  = static_cast<float>(space.width());
+    params.h  = static_cast<float>(space.height());
+    params.dt = dt;
+    params.taoRotation    = m_rotation;
+    params.burstX        -= ox;
+    params.burstY        -= oy;
+    params.attractorCount = 0;
+    for (const View &v : m_views)
+        for (int a = 0; a < v.attractorCount && params.attractorCount < SimulationParams::MAX_ATTRACTORS; ++a) {
+            params.attractorX[params.attractorCount] = static_cast<float>(v.attractors[a].x()) - ox;
+            params.attractorY[params.attractorCount] = static_cast<float>(v.attractors[a].y()) - oy;
+            ++params.attractorCount;
+        }
+
+    m_stepBounds = space;
+    m_job.params = params;
+    SimulationWorker::instance().submit(&m_job);
+    return true;
+}
+
+float SharedSimulation::rotation() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_rotation;
+}
+
+quint64 SharedSimulation::generation() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_generation;
+}
+
+int SharedSimulation::lastBurstEmitted() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_burstEmitted;
+}
+
+qint64 SharedSimulation::lastStepNsecs() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_stepNsecs;
+}
+
+int SharedSimulation::cull(const QRectF &viewport, float margin, float dpr, ParticleVertex *out,
+                           quint64 *generation) const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (generation)
+        *generation = m_generation;
+    // Viewport nello spazio dell'ultimo step pubblicato
+    return m_bins[m_front].cull(viewport.translated(-m_publishedBounds.topLeft()), margin, dpr, out);
+}
+
+// Worker thread, job ancora occupato: nessun advance() può toccare
+// m_stepBounds né il buffer di step. Il binning va nel buffer non pubblicato,
+// poi lo scambio avviene sotto lock.
+void SharedSimulation::Job::stepped()
+{
+    TraceSpan span("bin");
+    SharedSimulation &s = owner;
+    ParticleBins &back = s.m_bins[1 - s.m_front];
+    back.build(s.m_stepOut.data(), liveCount(),
+               static_cast<float>(s.m_stepBounds.width()),
+               static_cast<float>(s.m_stepBounds.height()));
+
+    std::lock_guard<std::mutex> lock(s.m_mutex);
+    s.m_front           = 1 - s.m_front;
+    s.m_publishedBounds = s.m_stepBounds;
+    s.m_burstEmitted    = s.m_system.lastBurstEmitted();
+    s.m_stepNsecs       = stepNsecs();
+    ++s.m_generation;
+}
+
+void SharedSimulation::Job::finished()
+{
+    const quint64 one = 1;
+    [[maybe_unused]] const ssize_t n = ::write(notifyFd, &one, sizeof(one));
+}
+
+void SharedSimulation::onNotify()
+{
+    quint64 value;
+    [[maybe_unused]] const ssize_t n = ::read(m_job.notifyFd, &value, sizeof(value));
+    Q_EMIT stepped();
+}
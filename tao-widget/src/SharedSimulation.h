@@ -0,0 +1,145 @@
+#ifndef SHAREDSIMULATION_H
+#define SHAREDSIMULATION_H
+
+#include "ParticleSystem.h"
+#include "SimulationWorker.h"
+
+#include <QElapsedTimer>
+#include <QObject>
+#include <QPointF>
+#include <QRectF>
+#include <QString>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+class QSocketNotifier;
+
+// ── ParticleBins ──────────────────────────────────────────────────────────────
+// Binning grossolano dei vertici vivi su una griglia di al più MAX_BINS×MAX_BINS
+// celle (counting sort, O(n), nessuna allocazione a regime). Ogni riga di celle
+// è contigua nel buffer ordinato: il culling di un viewport è una copia per
+// riga, senza test per particella.
+
+class ParticleBins
+{
+public:
+    static constexpr int   MAX_BINS = 64;
+    static constexpr float MIN_CELL = 64.0f;   // px
+
+    explicit ParticleBins(int capacity);
+
+    // Ordina per cella i primi `count` vertici di `in` (spazio w×h)
+    void build(const ParticleVertex *in, int count, float w, float h);
+
+    // Copia in `out` (capacità ≥ capacity) i vertici delle celle che toccano
+    // `rect` allargato di `margin`, traslati di -rect.topLeft() e con la size
+    // moltiplicata per `sizeScale`. Ritorna quanti.
+    int  cull(const QRectF &rect, float margin, float sizeScale, ParticleVertex *out) const;
+
+    int  count() const { return m_count; }
+
+private:
+    std::vector<ParticleVertex> m_sorted;
+    std::vector<int>            m_start;   // inizio di ogni cella (+ sentinella)
+    std::vector<int>            m_cursor;  // posizione di scrittura durante build()
+    int   m_binsX = 1, m_binsY = 1;
+    float m_cell  = MIN_CELL;
+    int   m_count = 0;
+};
+
+// ── SharedSimulation ──────────────────────────────────────────────────────────
+// Una simulazione per gruppo, nello spazio globale del desktop, condivisa da
+// più item (uno per schermo, es. lo sfondo). Lo spazio è il rettangolo che
+// contiene tutti i viewport registrati; il primo item pronto esegue lo step
+// (al più uno per intervallo), ciascuno poi legge solo le particelle del
+// proprio viewport. I metodi con viewport/cull possono essere chiamati dai
+// render thread di finestre diverse; acquire/release solo dal GUI thread.
+
+class SharedSimulation : public QObject
+{
+    Q_OBJECT
+
+public:
+    static constexpr int MAX_VIEWS     = 8;
+    static constexpr int MIN_STEP_MSEC = 12;   // più schermi a 60 Hz: uno step per vsync
+
+    static std::shared_ptr<SharedSimulation> acquire(const QString &group, int capacity);
+    ~SharedSimulation() override;
+
+    // Posizione (spazio globale) e input dell'item; da chiamare a ogni sync
+    void setView(const void *owner, const QRectF &viewport,
+                 const QPointF *attractors, int attractorCount);
+    void removeView(const void *owner);
+
+    // Spazio globale corrente (unione dei viewport)
+    QRectF bounds() const;
+
+    // Accoda uno step se il precedente è concluso e l'intervallo è trascorso.
+    // `params` porta aspetto, popolazione, ostacoli e burst (quest'ultimo in
+    // coordinate globali); dimensioni, dt,
+    // attrattori e rotazione del Tao (a `rotationRate` rad/s) li fissa la
+    // simulazione. Ritorna true se lo step è stato accodato.
+    bool advance(SimulationParams params, float rotationRate);
+
+    // Rotazione del Tao all'ultimo step accodato (rad)
+    float rotation() const;
+
+    // Ultimo stato pubblicato: numero di generazione e culling per viewport.
+    // Lo step lavora senza DPR (spriteScale = solo LOD): ogni schermo applica
+    // il proprio con `dpr` sulla size dei vertici copiati.
+    quint64 generation() const;
+    int     cull(const QRectF &viewport, float margin, float dpr, ParticleVertex *out,
+                 quint64 *generation) const;
+    // Particelle di burst emesse dall'ultimo step pubblicato
+    int     lastBurstEmitted() const;
+    // Durata (ns) del kernel nell'ultimo step pubblicato
+    qint64  lastStepNsecs() const;
+
+Q_SIGNALS:
+    // GUI thread: nuovo stato pubblicato
+    void stepped();
+
+private:
+    explicit SharedSimulation(const QString &group, int capacity);
+    void onNotify();
+
+    struct Job : SimulationJob {
+        Job(SharedSimulation &owner, ParticleSystem &system, ParticleVertex *out)
+            : SimulationJob(system, out), owner(owner) {}
+        SharedSimulation &owner;
+        int notifyFd = -1;
+    protected:
+        void stepped() override;
+        void finished() override;
+    };
+
+    struct View {
+        const void *owner = nullptr;
+        QRectF      rect;
+        int         attractorCount = 0;
+        QPointF     attractors[SimulationParams::MAX_ATTRACTORS];
+    };
+
+    QString                     m_group;
+    ParticleSystem              m_system;
+    std::vector<ParticleVertex> m_stepOut;       // output dello step (worker)
+    ParticleBins                m_bins[2];       // [m_front] pubblicato, l'altro in costruzione
+    int                         m_front = 0;
+    quint64                     m_generation = 0;
+    int                         m_burstEmitted = 0;
+    qint64                      m_stepNsecs    = 0;
+    QRectF                      m_stepBounds;    // spazio dell'ultimo step accodato
+    QRectF                      m_publishedBounds; // spazio di m_bins[m_front]
+
+    mutable std::mutex m_mutex;                  // viste, pubblicazione, advance
+    View               m_views[MAX_VIEWS];
+    float              m_rotation = 0.0f;
+    QElapsedTimer      m_clock;
+    qint64             m_lastStep = -1;
+
+    Job              m_job;
+    QSocketNotifier *m_notifier = nullptr;
+};
+
+#endif // SHAREDSIMULATION_H
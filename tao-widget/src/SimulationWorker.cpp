@@ -0,0 +1,90 @@
+#include "SimulationWorker.h"
+#include "TaoTrace.h"
+
+#include <chrono>
+
+// ═════════════════════════════════════════════════════════════════════════════
+// SimulationWorker
+// ═════════════════════════════════════════════════════════════════════════════
+
+SimulationWorker &SimulationWorker::instance()
+{
+    static SimulationWorker worker;
+    return worker;
+}
+
+SimulationWorker::SimulationWorker()
+{
+    // Uno step costa qualche centinaio di µs: oltre MAX_THREADS item che
+    // scattano nello stesso frame sono rari, e un core resta al render thread
+    const int cores = static_cast<int>(std::thread::hardware_concurrency());
+    m_threadCount = qBound(1, cores - 1, MAX_THREADS);
+    for (int i = 0; i < m_threadCount; ++i)
+        m_threads[i] = std::thread(&SimulationWorker::loop, this);
+}
+
+SimulationWorker::~SimulationWorker()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_quit = true;
+    }
+    m_wake.notify_all();
+    for (int i = 0; i < m_threadCount; ++i)
+        m_threads[i].join();
+}
+
+void SimulationWorker::submit(SimulationJob *job)
+{
+    if (job->m_busy.exchange(true, std::memory_order_acq_rel))
+        return;
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        job->m_next = nullptr;
+        if (m_tail) m_tail->m_next = job;
+        else        m_head         = job;
+        m_tail = job;
+    }
+    m_wake.notify_one();
+}
+
+void SimulationWorker::wait(SimulationJob *job)
+{
+    // Sempre sotto lock, anche a job già fermo: finished() potrebbe essere
+    // ancora in esecuzione sul worker.
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_idle.wait(lock, [job]() { return !job->busy(); });
+}
+
+void SimulationWorker::loop()
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    for (;;) {
+        m_wake.wait(lock, [this]() { return m_quit || m_head; });
+        if (!m_head)
+            return;   // m_quit e coda vuota
+
+        SimulationJob *job = m_head;
+        m_head = job->m_next;
+        if (!m_head) m_tail = nullptr;
+
+        lock.unlock();
+        {
+            TaoTrace::nameThread("simulation worker");
+            TraceSpan span("step");
+            const auto start = std::chrono::steady_clock::now();
+            job->m_live = job->m_system.step(job->params, job->m_out);
+            job->m_stepNsecs = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now() - start).count();
+            job->stepped();
+        }
+        lock.lock();
+
+        // Sotto lock: wait() non può perdere la notifica né tornare (e il
+        // job essere distrutto) prima che finished() sia concluso.
+        job->m_busy.store(false, std::memory_order_release);
+        job->finished();
+        m_idle.notify_all();
+    }
+}
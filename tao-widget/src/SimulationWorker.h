@@ -0,0 +1,95 @@
+#ifndef SIMULATIONWORKER_H
+#define SIMULATIONWORKER_H
+
+#include "ParticleSystem.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+// ── SimulationJob ─────────────────────────────────────────────────────────────
+// Uno step di simulazione riusabile: creato una volta per item, riaccodato a
+// ogni frame. Nessuna allocazione per dispatch (a differenza di un task
+// QtConcurrent, che alloca task, stato del QFuture e lambda catturata).
+
+class SimulationJob
+{
+public:
+    SimulationJob(ParticleSystem &system, ParticleVertex *out)
+        : m_system(system), m_out(out) {}
+    virtual ~SimulationJob() = default;
+
+    SimulationJob(const SimulationJob &) = delete;
+    SimulationJob &operator=(const SimulationJob &) = delete;
+
+    // Input dello step: scrivibile solo a job fermo
+    SimulationParams params;
+
+    // true dal submit() fino alla fine dello step
+    bool busy()      const { return m_busy.load(std::memory_order_acquire); }
+    // Particelle vive dopo l'ultimo step (valido a job fermo)
+    int  liveCount() const { return m_live; }
+    // Durata dell'ultimo step del kernel, ns (valido a job fermo; già
+    // valido anche dentro stepped())
+    qint64 stepNsecs() const { return m_stepNsecs; }
+
+protected:
+    // Chiamato sul worker thread subito dopo lo step, fuori dal lock e con
+    // busy() ancora true: lavoro aggiuntivo sull'output (es. binning).
+    virtual void stepped() {}
+
+    // Chiamato sul worker thread a step concluso (busy() già false), sotto il
+    // lock del worker: deve solo segnalare, non lavorare.
+    virtual void finished() {}
+
+private:
+    friend class SimulationWorker;
+
+    ParticleSystem   &m_system;
+    ParticleVertex   *m_out;
+    int               m_live = 0;
+    qint64            m_stepNsecs = 0;
+    SimulationJob    *m_next = nullptr;     // coda intrusiva del worker
+    std::atomic<bool> m_busy { false };
+};
+
+// ── SimulationWorker ──────────────────────────────────────────────────────────
+// Pool persistente di qualche thread per processo, condiviso da tutte le
+// istanze (plasmashell può ospitarne parecchie: un thread ciascuna sarebbe
+// uno spreco, un thread solo serializzerebbe i loro step). I thread prendono
+// i job da un'unica coda, che è una lista intrusiva dei job stessi: accodare
+// non alloca. Un job è in coda o in esecuzione al più una volta (busy()),
+// quindi ogni ParticleSystem resta su un thread alla volta.
+
+class SimulationWorker
+{
+public:
+    static constexpr int MAX_THREADS = 4;
+
+    static SimulationWorker &instance();
+
+    // Accoda il job; ignorato se è già in corso
+    void submit(SimulationJob *job);
+    // Blocca finché il job non è fermo
+    void wait(SimulationJob *job);
+
+    int threadCount() const { return m_threadCount; }
+
+    ~SimulationWorker();
+
+private:
+    SimulationWorker();
+    void loop();
+
+    std::mutex              m_mutex;
+    std::condition_variable m_wake;   // nuovi job / uscita
+    std::condition_variable m_idle;   // job conclusi (per wait())
+    SimulationJob          *m_head = nullptr;
+    SimulationJob          *m_tail = nullptr;
+    bool                    m_quit = false;
+    int                     m_threadCount = 0;
+    std::thread             m_threads[MAX_THREADS];
+};
+
+#endif // SIMULATIONWORKER_H
@@ -0,0 +1,351 @@
+#include "SoftwareRaster.h"
+
+#include <QPainter>
+#include <QtMath>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+// ═════════════════════════════════════════════════════════════════════════════
+// SoftwareRaster — stato
+// ═════════════════════════════════════════════════════════════════════════════
+
+SoftwareRaster::SoftwareRaster()
+    : m_sprites(MAX_SPRITE + 1)
+{
+}
+
+bool SoftwareRaster::Layers::operator==(const Layers &o) const
+{
+    if (center != o.center || radius != o.radius || rotation != o.rotation
+        || showClock != o.showClock || taoKey != o.taoKey)
+        return false;
+    for (int g = 0; g < 2; ++g)
+        if (glowSize[g] != o.glowSize[g] || glowKey[g] != o.glowKey[g])
+            return false;
+    if (showClock)
+        for (int h = 0; h < 3; ++h)
+            if (handAngle[h] != o.handAngle[h] || handColor[h] != o.handColor[h])
+                return false;
+    return true;
+}
+
+void SoftwareRaster::resize(int w, int h)
+{
+    if (m_image.width() == w && m_image.height() == h)
+        return;
+
+    m_image = QImage(qMax(0, w), qMax(0, h), QImage::Format_ARGB32_Premultiplied);
+    if (!m_image.isNull())
+        m_image.fill(Qt::transparent);
+
+    m_tilesX = (m_image.width()  + TILE - 1) / TILE;
+    m_tilesY = (m_image.height() + TILE - 1) / TILE;
+    const size_t tiles = static_cast<size_t>(m_tilesX) * m_tilesY;
+    m_particleTiles[0].assign(tiles, 0);
+    m_particleTiles[1].assign(tiles, 0);
+    m_redraw.assign(tiles, 0);
+
+    // Immagine vuota: i livelli vanno ridisegnati per intero
+    m_layers    = Layers();
+    m_layerRect = QRect();
+}
+
+void SoftwareRaster::setTaoImage(const QImage &image)
+{
+    m_tao = image.convertToFormat(QImage::Format_ARGB32_Premultiplied);
+}
+
+void SoftwareRaster::setGlowImage(int index, const QImage &image)
+{
+    m_glow[index] = image.convertToFormat(QImage::Format_ARGB32_Premultiplied);
+}
+
+// ═════════════════════════════════════════════════════════════════════════════
+// Tile
+// ═════════════════════════════════════════════════════════════════════════════
+
+QRect SoftwareRaster::tileRect(const QRect &px) const
+{
+    const QRect clipped = px & m_image.rect();
+    if (clipped.isEmpty())
+        return QRect();
+    return QRect(QPoint(clipped.left() / TILE, clipped.top() / TILE),
+                 QPoint(clipped.right() / TILE, clipped.bottom() / TILE));
+}
+
+void SoftwareRaster::markTiles(std::vector<quint8> &tiles, const QRect &px)
+{
+    const QRect t = tileRect(px);
+    if (t.isEmpty())
+        return;
+    for (int ty = t.top(); ty <= t.bottom(); ++ty)
+        std::memset(&tiles[static_cast<size_t>(ty) * m_tilesX + t.left()], 1, t.width());
+}
+
+// Tile da ridisegnare dentro `px`, come regione di clip per QPainter
+QRegion SoftwareRaster::redrawRegion(const QRect &px) const
+{
+    QRegion region;
+    const QRect t = tileRect(px);
+    if (t.isEmpty())
+        return region;
+    for (int ty = t.top(); ty <= t.bottom(); ++ty) {
+        const quint8 *row = &m_redraw[static_cast<size_t>(ty) * m_tilesX];
+        for (int tx = t.left(); tx <= t.right(); ++tx) {
+            if (!row[tx]) continue;
+            int end = tx;
+            while (end < t.right() && row[end + 1]) ++end;
+            region += QRect(tx * TILE, ty * TILE, (end - tx + 1) * TILE, TILE) & px;
+            tx = end;
+        }
+    }
+    return region;
+}
+
+// Azzera i tile da ridisegnare, una corsa di tile contigui per riga
+void SoftwareRaster::clearRedraw()
+{
+    uchar *bits = m_image.bits();
+    const qsizetype bpl = m_image.bytesPerLine();
+    const int w = m_image.width();
+    const int h = m_image.height();
+
+    for (int ty = 0; ty < m_tilesY; ++ty) {
+        const quint8 *row = &m_redraw[static_cast<size_t>(ty) * m_tilesX];
+        for (int tx = 0; tx < m_tilesX; ++tx) {
+            if (!row[tx]) continue;
+            int end = tx;
+            while (end + 1 < m_tilesX && row[end + 1]) ++end;
+
+            const int x0 = tx * TILE;
+            const int x1 = qMin(w, (end + 1) * TILE);
+            const int y1 = qMin(h, (ty + 1) * TILE);
+            for (int y = ty * TILE; y < y1; ++y)
+                std::memset(bits + y * bpl + x0 * 4, 0, static_cast<size_t>(x1 - x0) * 4);
+            tx = end;
+        }
+    }
+}
+
+// ═════════════════════════════════════════════════════════════════════════════
+// Sprite delle particelle
+// ═════════════════════════════════════════════════════════════════════════════
+
+// Stesso profilo di particle.frag con il blending della GPU (src·srcAlpha +
+// dst): colore × (t⁶·1.2 + t²·0.3)·t², alpha × t². Il pixel è dentro lo
+// sprite se il suo centro cade nel quadrato d×d di gl_PointCoord.
+const quint16 *SoftwareRaster::sprite(int d)
+{
+    std::vector<quint16> &s = m_sprites[d];
+    if (!s.empty())
+        return s.data();
+
+    const int stride = (d + 3) & ~3;
+    s.assign(static_cast<size_t>(stride) * d * 4, 0);
+    for (int j = 0; j < d; ++j)
+        for (int i = 0; i < d; ++i) {
+            const float u = (i + 0.5f) / d - 0.5f;
+            const float v = (j + 0.5f) / d - 0.5f;
+            const float distSq = (u * u + v * v) * 4.0f;
+            if (distSq > 1.0f) continue;
+
+            const float t  = 1.0f - distSq;
+            const float t2 = t * t;
+            const float intensity = t2 * t2 * t2 * 1.2f + t2 * 0.3f;
+            const auto  wc = static_cast<quint16>(std::lround(intensity * t2 * 256.0f));
+            const auto  wa = static_cast<quint16>(std::lround(t2 * 256.0f));
+
+            quint16 *p = &s[(static_cast<size_t>(j) * stride + i) * 4];
+            p[0] = p[1] = p[2] = wc;   // B, G, R (ARGB32 little-endian)
+            p[3] = wa;
+        }
+    return s.data();
+}
+
+bool SoftwareRaster::spriteRect(const ParticleVertex &v, float scale, int *x0, int *y0, int *d) const
+{
+    if (!(v.size > 0.0f) || (v.color >> 24) < 3)   // come il discard dello shader
+        return false;
+    *d  = qBound(1, static_cast<int>(v.size + 0.5f), MAX_SPRITE);
+    *x0 = static_cast<int>(std::floor(v.x * scale - *d * 0.5f + 0.5f));
+    *y0 = static_cast<int>(std::floor(v.y * scale - *d * 0.5f + 0.5f));
+    return *x0 < m_image.width() && *y0 < m_image.height() && *x0 + *d > 0 && *y0 + *d > 0;
+}
+
+// Somma satura dello sprite nell'immagine. Il colore del vertice è RGBA
+// premoltiplicato: il contributo è colore·alpha·peso, alpha·peso.
+void SoftwareRaster::splat(const ParticleVertex &v, float scale)
+{
+    int x0, y0, d;
+    if (!spriteRect(v, scale, &x0, &y0, &d))
+        return;
+
+    const quint32 a  = v.color >> 24;
+    const quint32 cr = ((v.color        & 0xff) * a + 127) / 255;
+    const quint32 cg = (((v.color >> 8)  & 0xff) * a + 127) / 255;
+    const quint32 cb = (((v.color >> 16) & 0xff) * a + 127) / 255;
+
+    const quint16 *weights = sprite(d);
+    const int stride = (d + 3) & ~3;
+    const int w  = m_image.width();
+    const int j0 = qMax(0, -y0);
+    const int j1 = qMin(d, m_image.height() - y0);
+    uchar *bits = m_image.bits();
+    const qsizetype bpl = m_image.bytesPerLine();
+
+#ifdef __SSE2__
+    // Sprite interamente dentro in orizzontale (righe piene, padding a peso 0)
+    if (x0 >= 0 && x0 + stride <= w) {
+        const __m128i color = _mm_setr_epi16(short(cb << 8), short(cg << 8), short(cr << 8), short(a << 8),
+                                             short(cb << 8), short(cg << 8), short(cr << 8), short(a << 8));
+        for (int j = j0; j < j1; ++j) {
+            auto *dst = reinterpret_cast<quint32 *>(bits + (y0 + j) * bpl) + x0;
+            const quint16 *wr = weights + static_cast<size_t>(j) * stride * 4;
+            for (int i = 0; i < stride; i += 4) {
+                // (c << 8)·w >> 16 = c·w >> 8; packus satura a 255
+                const __m128i w01 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(wr + i * 4));
+                const __m128i w23 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(wr + i * 4 + 8));
+                const __m128i add = _mm_packus_epi16(_mm_mulhi_epu16(color, w01),
+                                                     _mm_mulhi_epu16(color, w23));
+                auto *p = reinterpret_cast<__m128i *>(dst + i);
+                _mm_storeu_si128(p, _mm_adds_epu8(_mm_loadu_si128(p), add));
+            }
+        }
+        return;
+    }
+#endif
+
+    const int i0 = qMax(0, -x0);
+    const int i1 = qMin(d, w - x0);
+    const auto sat = [](quint32 dst, quint32 add) { return qMin<quint32>(255, dst + add); };
+    for (int j = j0; j < j1; ++j) {
+        auto *dst = reinterpret_cast<quint32 *>(bits + (y0 + j) * bpl) + x0;
+        const quint16 *wr = weights + static_cast<size_t>(j) * stride * 4;
+        for (int i = i0; i < i1; ++i) {
+            const quint16 *wp = wr + i * 4;
+            if (!wp[3]) continue;
+            const quint32 px = dst[i];
+            dst[i] = (sat(px >> 24,          a  * wp[3] >> 8) << 24)
+                   | (sat((px >> 16) & 0xff, cr * wp[2] >> 8) << 16)
+                   | (sat((px >> 8)  & 0xff, cg * wp[1] >> 8) << 8)
+                   |  sat(px & 0xff,         cb * wp[0] >> 8);
+        }
+    }
+}
+
+// ═════════════════════════════════════════════════════════════════════════════
+// Livelli statici (QPainter, ritagliati ai tile da ridisegnare)
+// ═════════════════════════════════════════════════════════════════════════════
+
+void SoftwareRaster::paintLayers(const SoftwareScene &scene, const QRegion &clip)
+{
+    QPainter p(&m_image);
+    p.setClipRegion(clip);
+    p.setRenderHint(QPainter::SmoothPixmapTransform);
+    p.setRenderHint(QPainter::Antialiasing);
+
+    const QPointF c = scene.center;
+    const qreal   r = scene.radius;
+
+    for (int g = 0; g < 2; ++g) {
+        const qreal gr = r * scene.glowSize[g];
+        if (scene.glowSize[g] > 0.01f && !m_glow[g].isNull())
+            p.drawImage(QRectF(c.x() - gr, c.y() - gr, 2 * gr, 2 * gr), m_glow[g]);
+    }
+
+    if (!m_tao.isNull()) {
+        p.save();
+        p.translate(c);
+        p.rotate(qRadiansToDegrees(scene.rotation));
+        p.drawImage(QRectF(-r, -r, 2 * r, 2 * r), m_tao);
+        p.restore();
+    }
+
+    if (scene.showClock)
+        for (int h = 0; h < 3; ++h) {
+            p.setPen(QPen(scene.handColor[h], scene.handWidth[h], Qt::SolidLine, Qt::FlatCap));
+            p.drawLine(c, c + QPointF(std::cos(scene.handAngle[h]), std::sin(scene.handAngle[h]))
+                              * scene.handLength[h]);
+        }
+}
+
+// ═════════════════════════════════════════════════════════════════════════════
+// Frame
+// ═════════════════════════════════════════════════════════════════════════════
+
+QRect SoftwareRaster::render(const SoftwareScene &scene)
+{
+    if (m_image.isNull())
+        return QRect();
+
+    // ── Tile delle particelle di questo frame ─────────────────────────────────
+    m_current = 1 - m_current;
+    std::vector<quint8>       &current  = m_particleTiles[m_current];
+    const std::vector<quint8> &previous = m_particleTiles[1 - m_current];
+    std::fill(current.begin(), current.end(), 0);
+
+    const float scale = scene.positionScale;
+    for (int k = 0; k < scene.particleCount; ++k) {
+        int x0, y0, d;
+        if (spriteRect(scene.particles[k], scale, &x0, &y0, &d))
+            markTiles(current, QRect(x0, y0, d, d));
+    }
+
+    // ── Livelli statici ───────────────────────────────────────────────────────
+    Layers layers;
+    layers.center    = scene.center;
+    layers.radius    = scene.radius;
+    layers.rotation  = scene.rotation;
+    layers.showClock = scene.showClock;
+    layers.taoKey    = m_tao.cacheKey();
+    for (int g = 0; g < 2; ++g) {
+        layers.glowSize[g] = scene.glowSize[g];
+        layers.glowKey[g]  = m_glow[g].cacheKey();
+    }
+    for (int h = 0; h < 3; ++h) {
+        layers.handAngle[h] = scene.handAngle[h];
+        layers.handColor[h] = scene.handColor[h].rgba();
+    }
+
+    // Ingombro: il quadrato del Tao ruotato, i glow, le lancette (≤ 0.9 r)
+    QRect layerRect;
+    if (scene.radius > 0.0f) {
+        const qreal extent = scene.radius * qMax<qreal>(M_SQRT2, qMax(scene.glowSize[0], scene.glowSize[1])) + 4.0;
+        layerRect = QRectF(scene.center.x() - extent, scene.center.y() - extent, 2 * extent, 2 * extent)
+                        .toAlignedRect() & m_image.rect();
+    }
+
+    // ── Tile da ridisegnare ───────────────────────────────────────────────────
+    for (size_t k = 0; k < m_redraw.size(); ++k)
+        m_redraw[k] = current[k] | previous[k];
+    if (!(layers == m_layers) || layerRect != m_layerRect) {
+        markTiles(m_redraw, m_layerRect);
+        markTiles(m_redraw, layerRect);
+        m_layers    = layers;
+        m_layerRect = layerRect;
+    }
+
+    QRect dirty;
+    for (int ty = 0; ty < m_tilesY; ++ty)
+        for (int tx = 0; tx < m_tilesX; ++tx)
+            if (m_redraw[static_cast<size_t>(ty) * m_tilesX + tx])
+                dirty |= QRect(tx * TILE, ty * TILE, TILE, TILE);
+    dirty &= m_image.rect();
+    if (dirty.isEmpty())
+        return dirty;
+
+    // ── Disegno: stesso ordine dello scene graph ──────────────────────────────
+    clearRedraw();
+    for (int k = 0; k < scene.particleCount; ++k)
+        splat(scene.particles[k], scale);
+
+    const QRegion clip = redrawRegion(m_layerRect);
+    if (!clip.isEmpty())
+        paintLayers(scene, clip);
+    return dirty;
+}
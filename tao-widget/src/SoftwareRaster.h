@@ -0,0 +1,105 @@
+#ifndef SOFTWARERASTER_H
+#define SOFTWARERASTER_H
+
+#include "ParticleSystem.h"
+
+#include <QColor>
+#include <QImage>
+#include <QPointF>
+#include <QRect>
+#include <QRegion>
+#include <vector>
+
+// ── SoftwareScene ─────────────────────────────────────────────────────────────
+// Un frame da rasterizzare, in pixel fisici dell'immagine.
+
+struct SoftwareScene {
+    QPointF center;
+    float   radius      = 0.0f;
+    float   rotation    = 0.0f;               // rad
+    float   glowSize[2] = { 0.0f, 0.0f };     // multipli del raggio, 0 = spento
+    bool    showClock   = false;
+    float   handAngle[3]  = {};               // rad, 0 = ore 3
+    float   handLength[3] = {};
+    float   handWidth[3]  = {};
+    QColor  handColor[3];
+
+    const ParticleVertex *particles = nullptr; // coordinate item, size in pixel
+    int     particleCount = 0;
+    float   positionScale = 1.0f;              // unità item → pixel (dpr)
+};
+
+// ── SoftwareRaster ────────────────────────────────────────────────────────────
+// Rasterizzazione su CPU dell'intera scena, per lo scene graph software e le
+// sessioni senza GPU: particelle, glow, Tao e lancette in una sola immagine
+// ARGB32 premoltiplicata, che lo scene graph disegna con un image node.
+//
+// Le particelle sono sprite precalcolati per diametro, con lo stesso profilo
+// di particle.frag (t⁶ + alone t²), sommati con saturazione come il blending
+// additivo della GPU (SSE2, 4 pixel per iterazione). Glow, Tao e lancette
+// passano da QPainter.
+//
+// Dirty rect a tile di TILE pixel: vengono ripuliti e ridisegnati solo i tile
+// toccati dalle particelle in questo frame o nel precedente, più l'area dei
+// livelli statici se sono cambiati (rotazione, lancette, texture).
+
+class SoftwareRaster
+{
+public:
+    static constexpr int TILE       = 32;
+    static constexpr int MAX_SPRITE = 128;   // diametro massimo, px
+
+    SoftwareRaster();
+
+    // Dimensione in pixel fisici; un cambio riparte da un'immagine vuota
+    void resize(int w, int h);
+    QSize size() const { return m_image.size(); }
+
+    void setTaoImage (const QImage &image);
+    void setGlowImage(int index, const QImage &image);
+
+    // Ritorna il rettangolo ridisegnato (vuoto = immagine invariata)
+    QRect render(const SoftwareScene &scene);
+
+    const QImage &image() const { return m_image; }
+
+private:
+    struct Layers {
+        QPointF center;
+        float   radius   = -1.0f;
+        float   rotation = 0.0f;
+        float   glowSize[2] = {};
+        bool    showClock = false;
+        float   handAngle[3] = {};
+        QRgb    handColor[3] = {};
+        qint64  taoKey = 0, glowKey[2] = {};
+
+        bool operator==(const Layers &o) const;
+    };
+
+    bool  spriteRect(const ParticleVertex &v, float scale, int *x0, int *y0, int *d) const;
+    void  markTiles(std::vector<quint8> &tiles, const QRect &px);
+    QRect tileRect(const QRect &px) const;
+    QRegion redrawRegion(const QRect &px) const;
+    void  clearRedraw();
+    void  splat(const ParticleVertex &v, float scale);
+    void  paintLayers(const SoftwareScene &scene, const QRegion &clip);
+    const quint16 *sprite(int d);
+
+    QImage m_image;
+    QImage m_tao, m_glow[2];
+
+    int    m_tilesX = 0, m_tilesY = 0;
+    std::vector<quint8> m_particleTiles[2];   // [m_current] questo frame, l'altro il precedente
+    std::vector<quint8> m_redraw;
+    int    m_current = 0;
+
+    Layers m_layers;                          // livelli statici presenti nell'immagine
+    QRect  m_layerRect;                       // loro ingombro, px
+
+    // Pesi per diametro (1..MAX_SPRITE): 4 quint16 per pixel (colore ×3,
+    // alpha) in 8.8, righe allineate a 4 pixel; generati al primo uso
+    std::vector<std::vector<quint16>> m_sprites;
+};
+
+#endif // SOFTWARERASTER_H
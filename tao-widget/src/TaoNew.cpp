@@ -1,42 +1,49 @@
 #include "TaoNew.h"
+#include "RasterNode.h"
+#include "TrailNode.h"
+#include "TaoTrace.h"
 
 #include <QSGGeometryNode>
-#include <QSGSimpleTextureNode>
+#include <QSGImageNode>
 #include <QSGFlatColorMaterial>
 #include <QSGTransformNode>
 #include <QQuickWindow>
+#include <QSocketNotifier>
+#include <QHoverEvent>
+#include <QTouchEvent>
 #include <QPainter>
+#include <QImageReader>
+#include <QUrl>
 #include <QRadialGradient>
-#include <QFileInfo>
+#include <QLoggingCategory>
 #include <QRandomGenerator>
 #include <QtConcurrent>
 #include <QtMath>
 #include <QTime>
-#include <dlfcn.h>
+#include <rhi/qrhi.h>
 #include <cstring>
 #include <cmath>
+#include <sys/eventfd.h>
+#include <unistd.h>
 
 // ═════════════════════════════════════════════════════════════════════════════
 // Helpers interni (file-scope)
 // ═════════════════════════════════════════════════════════════════════════════
 
-static QString shaderDirectory()
+// Prossima potenza di due ≥ px, limitata a [lo, hi]: le texture vengono
+// rigenerate solo quando il raggio a schermo cambia di "ottava".
+static int textureBucket(float px, int lo, int hi)
 {
-    Dl_info info;
-    if (dladdr(reinterpret_cast<void*>(&shaderDirectory), &info) && info.dli_fname)
-        return QFileInfo(QString::fromUtf8(info.dli_fname)).absolutePath();
-    return {};
+    int size = lo;
+    while (size < px && size < hi)
+        size <<= 1;
+    return qMin(size, hi);
 }
 
-// Premoltiplica l'alpha e impacchetta RGBA in un quint32 (formato GPU).
-static inline quint32 packColor(unsigned char r, unsigned char g,
-                                unsigned char b, unsigned char a)
+// Texture con mipmap: il Tao resta nitido anche molto rimpicciolito.
+static QSGTexture *createMipmappedTexture(QQuickWindow *window, const QImage &img)
 {
-    const float af = a / 255.0f;
-    const auto pr  = static_cast<unsigned char>(r * af);
-    const auto pg  = static_cast<unsigned char>(g * af);
-    const auto pb  = static_cast<unsigned char>(b * af);
-    return (quint32(a) << 24) | (quint32(pb) << 16) | (quint32(pg) << 8) | quint32(pr);
+    return window->createTextureFromImage(img, QQuickWindow::TextureHasMipmaps);
 }
 
 // Attributi geometria: pos(xy) + size(float) + color(4×ubyte) = 16 byte/vertice.
@@ -60,9 +67,9 @@ class ParticleMaterialShader : public QSGMaterialShader
 public:
     ParticleMaterialShader()
     {
-        const QString dir = shaderDirectory();
-        setShaderFileName(VertexStage,   dir + QStringLiteral("/shaders/particle.vert.qsb"));
-        setShaderFileName(FragmentStage, dir + QStringLiteral("/shaders/particle.frag.qsb"));
+        // Compilati da src/shaders con qt_add_shaders (CMakeLists.txt) e incorporati come risorse Qt
+        setShaderFileName(VertexStage,   QStringLiteral(":/taoplugin/shaders/particle.vert.qsb"));
+        setShaderFileName(FragmentStage, QStringLiteral(":/taoplugin/shaders/particle.frag.qsb"));
         setFlag(UpdatesGraphicsPipelineState, true);
     }
 
@@ -99,6 +106,16 @@ public:
             memcpy(buf->data() + 64, &op, 4);
             changed = true;
         }
+        // sizeScale: sempre 1 a schermo (solo TrailNode lo riduce)
+        if (buf->size() >= 72) {
+            float scale;
+            memcpy(&scale, buf->data() + 68, 4);
+            if (scale != 1.0f) {
+                scale = 1.0f;
+                memcpy(buf->data() + 68, &scale, 4);
+                changed = true;
+            }
+        }
         return changed;
     }
 };
@@ -129,14 +146,45 @@ TaoNew::TaoNew(QQuickItem *parent)
     : QQuickItem(parent)
 {
     setFlag(ItemHasContents, true);
+    setAcceptHoverEvents(true);
+    setAcceptTouchEvents(true);
+
+    // Registrazione dell'input fin dall'avvio (es. per catturare una sessione reale)
+    const QString recordPath = qEnvironmentVariable("TAO_RECORD");
+    if (!recordPath.isEmpty())
+        setRecordPath(recordPath);
+
+    // Tempi per frame fin dall'avvio (log con QT_LOGGING_RULES="tao.native.debug=true")
+    if (qEnvironmentVariableIntValue("TAO_TIMING"))
+        setTimingEnabled(true);
+    const QString tracePath = qEnvironmentVariable("TAO_TRACE");
+    if (!tracePath.isEmpty())
+        setTracePath(tracePath);
+
+    // Fine step: eventfd scritto dal worker, letto qui sul GUI thread
+    m_stepJob.notifyFd = ::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (m_stepJob.notifyFd >= 0) {
+        m_stepNotifier = new QSocketNotifier(m_stepJob.notifyFd, QSocketNotifier::Read, this);
+        connect(m_stepNotifier, &QSocketNotifier::activated, this, &TaoNew::stepFinished);
+    } else {
+        qCWarning(lcTao) << "eventfd failed, simulation disabled";
+    }
 
-    m_particles.resize(MAX_PARTICLES);
-    m_verticesRender.resize(MAX_PARTICLES);
-    std::memset(m_particles.data(), 0, sizeof(ParticleData) * MAX_PARTICLES);
+    // Item piccoli (LOD) non seguono il vsync: il frame successivo viene
+    // richiesto al primo tick dopo la fine dello step.
+    connect(&m_lodTimer, &QTimer::timeout, this, &TaoNew::lodTick);
 
-    connect(&m_watcher, &QFutureWatcher<void>::finished, this, [this]() {
-        m_renderActiveCount = m_pendingActiveCount.load();
-        m_simulationPending = false;
+    connect(&m_maskWatcher, &QFutureWatcher<ObstacleMaskData>::finished, this, [this]() {
+        TaoTrace::instant("mask ready");
+        m_maskJobPending = false;
+        m_maskReady      = true;
+        update();
+    });
+
+    connect(&m_textureWatcher, &QFutureWatcher<TaoTextureSet>::finished, this, [this]() {
+        TaoTrace::instant("textures ready");
+        m_textureJobPending = false;
+        m_texturesReady     = true;
         update();
     });
 
@@ -145,8 +193,76 @@ TaoNew::TaoNew(QQuickItem *parent)
 
 TaoNew::~TaoNew()
 {
-    if (m_watcher.isRunning())
-        m_watcher.waitForFinished();
+    if (m_shared)
+        m_shared->removeView(this);
+    SimulationWorker::instance().wait(&m_stepJob);
+    delete m_stepNotifier;
+    if (m_stepJob.notifyFd >= 0)
+        ::close(m_stepJob.notifyFd);
+    m_recorder.close();
+    if (m_textureWatcher.isRunning())
+        m_textureWatcher.waitForFinished();
+    if (m_maskWatcher.isRunning())
+        m_maskWatcher.waitForFinished();
+    if (!m_tracePath.isEmpty())
+        TaoTrace::release();
+}
+
+// ═════════════════════════════════════════════════════════════════════════════
+// Fine step (GUI thread)
+// ═════════════════════════════════════════════════════════════════════════════
+
+void TaoNew::StepJob::finished()
+{
+    const quint64 one = 1;
+    [[maybe_unused]] const ssize_t n = ::write(notifyFd, &one, sizeof(one));
+}
+
+void TaoNew::stepFinished()
+{
+    quint64 value;
+    [[maybe_unused]] const ssize_t n = ::read(m_stepJob.notifyFd, &value, sizeof(value));
+
+    TaoTrace::nameThread("GUI");
+    TraceSpan span("step finished");
+    if (!m_simulationPending || m_stepJob.busy())
+        return;
+
+    m_renderActiveCount = m_stepJob.liveCount();
+    m_burstPending.fetch_sub(m_system.lastBurstEmitted());
+    m_simulationPending = false;
+
+    if (m_lodFrameInterval > 0) {
+        m_frameDue = true;
+        if (!m_lodTimer.isActive() || m_lodTimer.interval() != m_lodFrameInterval)
+            m_lodTimer.start(m_lodFrameInterval);
+    } else {
+        m_lodTimer.stop();
+        update();
+    }
+}
+
+// Nuovo stato della simulazione condivisa: ridisegna (il culling avviene
+// nel sync). Il burst si scala solo se lo step l'ha accodato questo item.
+void TaoNew::sharedStepped()
+{
+    TaoTrace::nameThread("GUI");
+    TaoTrace::instant("shared step published");
+    if (m_sharedSubmitted) {
+        m_sharedSubmitted = false;
+        m_burstPending.fetch_sub(qMin(m_shared->lastBurstEmitted(), m_burstPending.load()));
+    }
+    update();
+}
+
+void TaoNew::lodTick()
+{
+    if (m_frameDue) {
+        m_frameDue = false;
+        update();
+    } else if (!m_simulationPending) {
+        m_lodTimer.stop();   // simulazione ferma: nessun tick a vuoto
+    }
 }
 
 // ═════════════════════════════════════════════════════════════════════════════
@@ -256,12 +372,214 @@ void TaoNew::setParticleSizeRandom(double s) {
     update();
 }
 
+void TaoNew::setLodEnabled(bool enabled) {
+    if (m_lodEnabled == enabled) return;
+    m_lodEnabled = enabled;
+    Q_EMIT lodEnabledChanged();
+    update();
+}
+
+void TaoNew::setLodFullSize(int size) {
+    const int bounded = qMax(1, size);
+    if (m_lodFullSize == bounded) return;
+    m_lodFullSize = bounded;
+    Q_EMIT lodFullSizeChanged();
+    update();
+}
+
+void TaoNew::setLodMinSize(int size) {
+    const int bounded = qMax(0, size);
+    if (m_lodMinSize == bounded) return;
+    m_lodMinSize = bounded;
+    Q_EMIT lodMinSizeChanged();
+    update();
+}
+
+void TaoNew::setEmissionBudget(int budget) {
+    const int bounded = qBound(0, budget, MAX_PARTICLES);
+    if (m_emissionBudget == bounded) return;
+    m_emissionBudget = bounded;
+    Q_EMIT emissionBudgetChanged();
+}
+
+void TaoNew::emitBurst(int count, const QPointF &pos) {
+    if (count <= 0) return;
+    m_burstPos = pos;
+    // Il worker li emette un budget alla volta; il totale in attesa satura a
+    // MAX_PARTICLES (il pool non ne contiene di più), così raffiche ripetute
+    // non accumulano un arretrato da smaltire per secondi
+    const int add = qMin(count, MAX_PARTICLES);
+    int pending = m_burstPending.load();
+    while (!m_burstPending.compare_exchange_weak(pending, qMin(pending + add, MAX_PARTICLES))) {}
+    update();
+}
+
+void TaoNew::setSimulationSeed(int seed) {
+    if (m_simulationSeed == seed) return;
+    m_simulationSeed = seed;
+    // 0 = casuale; altrimenti il kernel riparte da un pool vuoto con questo seed
+    if (seed != 0) {
+        m_activeSeed   = static_cast<quint32>(seed);
+        m_resetPending = true;
+    }
+    Q_EMIT simulationSeedChanged();
+    update();
+}
+
+void TaoNew::setFixedTimeStep(double dt) {
+    const double bounded = qBound(0.0, dt, 1.0);
+    if (qFuzzyCompare(m_fixedTimeStep, bounded)) return;
+    m_fixedTimeStep = bounded;
+    Q_EMIT fixedTimeStepChanged();
+}
+
+void TaoNew::setRecordPath(const QString &path) {
+    if (m_recordPath == path) return;
+    m_recordPath = path;
+    // Il file viene aperto/chiuso in updateSimulation, a worker fermo
+    m_recorderDirty = true;
+    Q_EMIT recordPathChanged();
+    update();
+}
+
+void TaoNew::setTrailEnabled(bool enabled) {
+    if (m_trailEnabled == enabled) return;
+    m_trailEnabled = enabled;
+    Q_EMIT trailEnabledChanged();
+    update();
+}
+
+void TaoNew::setSoftwareRendering(bool enabled) {
+    if (m_softwareRendering == enabled) return;
+    m_softwareRendering = enabled;
+    Q_EMIT softwareRenderingChanged();
+    update();
+}
+
+void TaoNew::setTrailDecay(double decay) {
+    const double bounded = qBound(0.0, decay, 0.99);
+    if (qFuzzyCompare(m_trailDecay, bounded)) return;
+    m_trailDecay = bounded;
+    Q_EMIT trailDecayChanged();
+    update();
+}
+
+void TaoNew::setTrailResolution(double scale) {
+    const double bounded = qBound(0.1, scale, 1.0);
+    if (qFuzzyCompare(m_trailResolution, bounded)) return;
+    m_trailResolution = bounded;
+    Q_EMIT trailResolutionChanged();
+    update();
+}
+
+void TaoNew::setObstacleShapes(int shapes) {
+    const int bounded = shapes & (ObstacleTao | ObstacleDots | ObstacleHands | ObstacleMask);
+    if (m_obstacleShapes == bounded) return;
+    m_obstacleShapes = bounded;
+    Q_EMIT obstacleShapesChanged();
+    update();
+}
+
+void TaoNew::setObstacleMask(const QString &path) {
+    if (m_obstacleMask == path) return;
+    m_obstacleMask = path;
+    Q_EMIT obstacleMaskChanged();
+    update();
+}
+
+void TaoNew::setFlowEnabled(bool enabled) {
+    if (m_flowEnabled == enabled) return;
+    m_flowEnabled = enabled;
+    Q_EMIT flowEnabledChanged();
+    update();
+}
+
+void TaoNew::setFlowStrength(double strength) {
+    const double bounded = qBound(0.0, strength, 3.0);
+    if (qFuzzyCompare(m_flowStrength, bounded)) return;
+    m_flowStrength = bounded;
+    Q_EMIT flowStrengthChanged();
+    update();
+}
+
+void TaoNew::setFlowScale(double scale) {
+    const double bounded = qBound(0.1, scale, 2.0);
+    if (qFuzzyCompare(m_flowScale, bounded)) return;
+    m_flowScale = bounded;
+    Q_EMIT flowScaleChanged();
+    update();
+}
+
+void TaoNew::setFlowSwirl(double swirl) {
+    const double bounded = qBound(0.0, swirl, 2.0);
+    if (qFuzzyCompare(m_flowSwirl, bounded)) return;
+    m_flowSwirl = bounded;
+    Q_EMIT flowSwirlChanged();
+    update();
+}
+
 void TaoNew::setMousePos(const QPointF &pos) {
     if (m_mousePos == pos) return;
     m_mousePos = pos;
     Q_EMIT mousePosChanged();
 }
 
+void TaoNew::setSharedGroup(const QString &group) {
+    if (m_sharedGroup == group) return;
+    m_sharedGroup = group;
+    // GUI thread: il render thread usa m_shared solo durante il sync
+    if (m_shared) {
+        disconnect(m_shared.get(), nullptr, this, nullptr);
+        m_shared->removeView(this);
+        m_shared.reset();
+    }
+    if (!group.isEmpty()) {
+        m_shared = SharedSimulation::acquire(group, MAX_PARTICLES);
+        connect(m_shared.get(), &SharedSimulation::stepped, this, &TaoNew::sharedStepped);
+    }
+    m_sharedSubmitted = false;
+    Q_EMIT sharedGroupChanged();
+    update();
+}
+
+void TaoNew::setViewport(const QRectF &rect) {
+    if (m_viewport == rect) return;
+    m_viewport = rect;
+    Q_EMIT viewportChanged();
+    update();
+}
+
+void TaoNew::setTimingEnabled(bool enabled) {
+    if (m_timingEnabled == enabled) return;
+    m_timingEnabled = enabled;
+    Q_EMIT timingEnabledChanged();
+    update();
+}
+
+// Più item possono scrivere nella stessa traccia di processo: il file viene
+// prodotto quando l'ultimo la rilascia
+void TaoNew::setTracePath(const QString &path) {
+    if (m_tracePath == path) return;
+    if (!m_tracePath.isEmpty())
+        TaoTrace::release();
+    m_tracePath = path;
+    if (!m_tracePath.isEmpty())
+        TaoTrace::acquire(m_tracePath);
+    Q_EMIT tracePathChanged();
+}
+
+QString TaoNew::gpuTimingStatus() const
+{
+    switch (static_cast<GpuTiming>(m_gpuTimingStatus.load())) {
+    case GpuTiming::Pending:     return QStringLiteral("pending");
+    case GpuTiming::Ok:          return QStringLiteral("ok");
+    case GpuTiming::Inactive:    return QStringLiteral("inactive");
+    case GpuTiming::Unsupported: return QStringLiteral("unsupported");
+    case GpuTiming::Off:         break;
+    }
+    return QStringLiteral("off");
+}
+
 // ═════════════════════════════════════════════════════════════════════════════
 // itemChange
 // ═════════════════════════════════════════════════════════════════════════════
@@ -273,6 +591,76 @@ void TaoNew::itemChange(ItemChange change, const ItemChangeData &value)
     QQuickItem::itemChange(change, value);
 }
 
+// ═════════════════════════════════════════════════════════════════════════════
+// Input nativo (GUI thread)
+// ═════════════════════════════════════════════════════════════════════════════
+// Gli eventi arrivano alla frequenza del dispositivo; qui si salva solo
+// l'ultimo stato. Il campionamento avviene una volta per step, in
+// updateSimulation, mentre il GUI thread è bloccato nel sync.
+
+void TaoNew::hoverEnterEvent(QHoverEvent *event)
+{
+    m_hoverPos    = event->position();
+    m_hoverActive = true;
+}
+
+void TaoNew::hoverMoveEvent(QHoverEvent *event)
+{
+    m_hoverPos    = event->position();
+    m_hoverActive = true;
+}
+
+void TaoNew::hoverLeaveEvent(QHoverEvent *)
+{
+    m_hoverActive = false;
+}
+
+void TaoNew::touchEvent(QTouchEvent *event)
+{
+    m_touchCount = 0;
+    if (event->type() != QEvent::TouchCancel) {
+        for (const QEventPoint &pt : event->points()) {
+            if (pt.state() == QEventPoint::Released)
+                continue;
+            if (m_touchCount == MAX_TOUCH_POINTS)
+                break;
+            m_touchPoints[m_touchCount++] = pt.position();
+        }
+    }
+    // Accettato anche il TouchBegin: altrimenti gli aggiornamenti non arrivano
+    event->accept();
+}
+
+// ═════════════════════════════════════════════════════════════════════════════
+// computeLod
+// ═════════════════════════════════════════════════════════════════════════════
+
+// Il lato equivalente sqrt(w·h) viene confrontato con le soglie:
+//  ≥ lodFullSize   → qualità piena;
+//  sotto           → particelle ∝ area, sprite ∝ lato, step a 30 Hz sotto metà soglia;
+//  ≤ lodMinSize    → icona da pannello: step a 20 Hz.
+TaoNew::LodLevel TaoNew::computeLod(float w, float h) const
+{
+    LodLevel lod;
+    if (!m_lodEnabled || w <= 0.0f || h <= 0.0f)
+        return lod;
+
+    const float side = std::sqrt(w * h);
+    const float full = static_cast<float>(qMax(m_lodFullSize, m_lodMinSize + 1));
+    if (side >= full)
+        return lod;
+
+    const float t    = side / full;
+    lod.countScale   = qBound(0.05f, t * t, 1.0f);
+    lod.sizeScale    = qBound(0.35f, t, 1.0f);
+
+    if (side <= static_cast<float>(m_lodMinSize))
+        lod.frameInterval = 50;
+    else if (side < full * 0.5f)
+        lod.frameInterval = 33;
+    return lod;
+}
+
 // ═════════════════════════════════════════════════════════════════════════════
 // updateSimulation  (asincrono, worker thread)
 // ═════════════════════════════════════════════════════════════════════════════
@@ -280,181 +668,283 @@ void TaoNew::itemChange(ItemChange change, const ItemChangeData &value)
 void TaoNew::updateSimulation()
 {
     if (m_simulationPending) return;
+    TraceSpan span("dispatch");
+
+    // Cambio modo (privata ↔ condivisa) a worker privato fermo: il buffer
+    // vertici riparte vuoto, senza particelle dell'altra modalità
+    const bool shared = m_shared != nullptr;
+    if (shared != m_sharedActive) {
+        m_sharedActive = shared;
+        for (int k = 0; k < m_renderActiveCount; ++k)
+            m_verticesRender[k].size = 0.0f;
+        m_system.clear(m_verticesRender.data());
+        m_renderActiveCount = 0;
+        m_sharedGeneration  = 0;
+    }
+    if (shared) {
+        updateSharedSimulation();
+        return;
+    }
+
+    // Step privato appena concluso: la sua durata è ora stabile
+    if (m_stepTimed) {
+        m_stepTimed = false;
+        if (m_timingActive) {
+            m_stepSum += static_cast<double>(m_stepJob.stepNsecs()) / 1e6;
+            ++m_stepSamples;
+        }
+    }
+
     m_simulationPending = true;
 
-    const int count = m_particleCount;
+    // Worker fermo: momento sicuro per (ri)aprire la registrazione e per
+    // riavviare il kernel con un nuovo seed
+    if (m_recorderDirty) {
+        m_recorderDirty = false;
+        m_recorder.close();
+        if (!m_recordPath.isEmpty()) {
+            // Un seed noto è indispensabile per il replay: se non impostato
+            // ne viene estratto uno e il kernel riparte da lì.
+            if (m_simulationSeed == 0)
+                m_activeSeed = QRandomGenerator::global()->generate();
+            m_resetPending = true;
+            if (!m_recorder.open(m_recordPath, m_activeSeed))
+                qCWarning(lcTao) << "cannot open recording" << m_recordPath;
+        }
+    }
+
+    if (m_resetPending) {
+        m_resetPending = false;
+        m_system.reset(m_activeSeed);
+        m_system.clear(m_verticesRender.data());
+    }
+
+    const float    w   = width();
+    const float    h   = height();
+    const LodLevel lod = computeLod(w, h);
+    m_lodFrameInterval = lod.frameInterval;
+
+    const int count = m_particleCount > 0
+        ? qMax(1, qRound(m_particleCount * lod.countScale))
+        : 0;
+
+    // ── Maschera ostacoli (worker fermo: il campo si può toccare) ─────────────
+    if (m_maskReady) {
+        m_maskReady = false;
+        TraceSpan maskSpan("mask apply");
+        ObstacleMaskData mask = m_maskWatcher.result();
+        if (mask.path == m_obstacleMask) {
+            m_system.obstacles().setMask(std::move(mask.distance), mask.gw, mask.gh);
+            m_maskApplied = true;
+        }
+    }
+    const bool wantMask = (m_obstacleShapes & ObstacleMask) && !m_obstacleMask.isEmpty();
+    if (wantMask) {
+        int gw, gh;
+        ObstacleField::gridSize(w, h, &gw, &gh);
+        if ((gw != m_maskRequestW || gh != m_maskRequestH || m_obstacleMask != m_maskRequestPath)
+            && !m_maskJobPending)
+            requestObstacleMask(gw, gh);
+    } else if (m_maskApplied) {
+        m_system.obstacles().setMask({}, 0, 0);
+        m_maskApplied     = false;
+        m_maskRequestPath.clear();
+    }
 
     if (count <= 0) {
-        for (int i = 0; i < MAX_PARTICLES; ++i)
-            m_verticesRender[i].size = 0.0f;
+        m_system.clear(m_verticesRender.data());
         m_renderActiveCount = 0;
-        m_pendingActiveCount.store(0);
         m_simulationPending = false;
         update();
         return;
     }
 
-    // Snapshot dei parametri necessari al worker — nessun accesso a `this`
-    // dentro la lambda eccetto per i buffer che sono stabili per tutta la vita
-    // dell'oggetto e non vengono riallocati durante la simulazione.
-    const float   w          = width();
-    const float   h          = height();
-    const QPointF mPos       = m_mousePos;
-    const float   dt         = (m_lastDt > 0.001f && m_lastDt < 1.0f) ? m_lastDt : 0.016f;
-    const QColor  pc1        = m_particleColor1;
-    const QColor  pc2        = m_particleColor2;
-    const float   pSize      = static_cast<float>(m_particleSize);
-    const float   pSizeRand  = static_cast<float>(m_particleSizeRandom);
-    const float   dpr        = window() ? static_cast<float>(window()->devicePixelRatio()) : 1.0f;
-
-    QFuture<void> future = QtConcurrent::run([this, count, w, h, mPos, dt, pc1, pc2, pSize, pSizeRand, dpr]()
-    {
-        const float cx  = w * 0.5f;
-        const float cy  = h * 0.5f;
-        const float r   = qMin(w, h) / 4.5f;
-        const float rSq = r * r;
-        const float df  = dt * 60.0f;
-
-        // Friction pre-calcolata fuori dal loop
-        const float friction = std::pow(0.98f, df);
-
-        // Generatore casuale locale → nessun lock sul generatore globale
-        QRandomGenerator rng(QRandomGenerator::global()->generate());
-
-        const bool  mouseValid = (mPos.x() >= 0 && mPos.x() <= w &&
-                                  mPos.y() >= 0 && mPos.y() <= h);
-        const float mx = static_cast<float>(mPos.x());
-        const float my = static_cast<float>(mPos.y());
-
-        // Canali colore estratti una volta per tutte
-        const auto pc1r = static_cast<unsigned char>(pc1.red());
-        const auto pc1g = static_cast<unsigned char>(pc1.green());
-        const auto pc1b = static_cast<unsigned char>(pc1.blue());
-        const auto pc2r = static_cast<unsigned char>(pc2.red());
-        const auto pc2g = static_cast<unsigned char>(pc2.green());
-        const auto pc2b = static_cast<unsigned char>(pc2.blue());
-
-        ParticleData   *pData = m_particles.data();
-        ParticleVertex *vData = m_verticesRender.data();
-
-        // Buffer fisso: le particelle "morte" ricevono size=0 e vengono
-        // scartate dalla GPU senza alcuna riallocazione del buffer driver.
-        for (int i = 0; i < count; ++i)
-        {
-            ParticleData   &p = pData[i];
-            ParticleVertex &v = vData[i];
-
-            if (p.life > 0.0f)
-            {
-                // ── Interazione mouse ──────────────────────────────────────
-                const float dx = mx - p.x;
-                const float dy = my - p.y;
-
-                if (mouseValid && qAbs(dx) < 300.0f && qAbs(dy) < 300.0f) {
-                    const float distSq = dx*dx + dy*dy;
-                    if (distSq < 90000.0f) {
-                        const float f = 3.5f / (distSq + 100.0f);
-                        p.vx += dx * f * df;
-                        p.vy += dy * f * df;
-                    } else {
-                        p.vx *= friction;
-                        p.vy *= friction;
-                    }
-                } else {
-                    p.vx *= friction;
-                    p.vy *= friction;
-                }
-
-                // ── Integrazione posizione ─────────────────────────────────
-                p.x += p.vx * df;
-                p.y += p.vy * df;
-
-                // Rimbalzo sui bordi
-                if      (p.x < 0) { p.x = 0; p.vx =  qAbs(p.vx) * 0.4f; }
-                else if (p.x > w) { p.x = w; p.vx = -qAbs(p.vx) * 0.4f; }
-                if      (p.y < 0) { p.y = 0; p.vy =  qAbs(p.vy) * 0.4f; }
-                else if (p.y > h) { p.y = h; p.vy = -qAbs(p.vy) * 0.4f; }
-
-                // ── Collisione con il cerchio Tao ──────────────────────────
-                const float tdx     = p.x - cx;
-                const float tdy     = p.y - cy;
-                const float tDistSq = tdx*tdx + tdy*tdy;
-                if (tDistSq < rSq) {
-                    const float tDist   = std::sqrt(tDistSq);
-                    const float safeDist = (tDist < 0.1f) ? 0.1f : tDist;
-                    const float inv     = 1.0f / safeDist;
-                    const float nx      = tdx * inv;
-                    const float ny      = tdy * inv;
-                    const float push    = (r - safeDist) * 0.3f;
-                    p.x += nx * push;
-                    p.y += ny * push;
-                    const float dot = p.vx * nx + p.vy * ny;
-                    if (dot < 0) {
-                        p.vx -= 1.6f * dot * nx;
-                        p.vy -= 1.6f * dot * ny;
-                    }
-                }
-
-                // ── Aging e colore ─────────────────────────────────────────
-                p.life -= p.decay * df;
-
-                const auto alpha = static_cast<unsigned char>(p.life * 255.0f * 0.85f);
-                unsigned char red, green, blue;
-
-                if ((i % 7) == 0) {
-                    // Colore secondario: variazione in base alla vita residua
-                    red   = pc2r;
-                    green = static_cast<unsigned char>(qMin(255, (int)pc2g + (int)(p.life * 50)));
-                    blue  = pc2b;
-                } else {
-                    // Colore primario: shift warm in base alla velocità
-                    const float speedSq = p.vx*p.vx + p.vy*p.vy;
-                    red   = static_cast<unsigned char>(qMin(255.0f, (float)pc1r + speedSq * 8.0f));
-                    green = static_cast<unsigned char>(qMin(255.0f, (float)pc1g + speedSq * 4.0f));
-                    blue  = pc1b;
-                }
-                p.packedColor = packColor(red, green, blue, alpha);
-
-                v.x     = p.x;
-                v.y     = p.y;
-                v.size  = p.size * dpr;   // scala per HiDPI/Retina
-                v.color = p.packedColor;
-            }
-            else
-            {
-                // ── Respawn ────────────────────────────────────────────────
-                p.life = 1.0f;
-                const double angle = rng.generateDouble() * 6.28318;
-                const double dist  = r * (0.5 + rng.generateDouble() * 2.0);
-                p.x  = cx + static_cast<float>(std::cos(angle) * dist);
-                p.y  = cy + static_cast<float>(std::sin(angle) * dist);
-                p.vx = static_cast<float>((rng.generateDouble() - 0.5) * 0.6);
-                p.vy = static_cast<float>((rng.generateDouble() - 0.5) * 0.6);
-
-                // Sposta fuori dal cerchio se ci è finita dentro
-                const float sdx = p.x - cx;
-                const float sdy = p.y - cy;
-                if (sdx*sdx + sdy*sdy < rSq)
-                    p.x += (sdx > 0 ? r : -r);
-
-                p.decay = 0.003f + static_cast<float>(rng.generateDouble()) * 0.008f;
-                // Raggio personalizzabile
-                p.size  = pSize + static_cast<float>(rng.generateDouble()) * pSizeRand;
-                p.packedColor = packColor(pc1r, pc1g, pc1b, static_cast<unsigned char>(255 * 0.85f));
-
-                // Frame invisibile per il respawn: evita pop visivi
-                v.x = p.x; v.y = p.y; v.size = 0.0f; v.color = p.packedColor;
-            }
+    // Snapshot di tutto l'input dello step: il worker non legge proprietà
+    // di `this`, solo il kernel e il buffer vertici (stabili per tutta la
+    // vita dell'oggetto, mai riallocati durante la simulazione).
+    SimulationParams params;
+    params.w          = w;
+    params.h          = h;
+    QPointF attractors[SimulationParams::MAX_ATTRACTORS];
+    params.attractorCount = collectAttractors(attractors);
+    for (int a = 0; a < params.attractorCount; ++a) {
+        params.attractorX[a] = static_cast<float>(attractors[a].x());
+        params.attractorY[a] = static_cast<float>(attractors[a].y());
+    }
+    params.dt         = m_fixedTimeStep > 0.0
+        ? static_cast<float>(m_fixedTimeStep)
+        : ((m_lastDt > 0.001f && m_lastDt < 1.0f) ? m_lastDt : 0.016f);
+    params.count      = count;
+    // Budget di emissione: 0 = automatico (pool ripopolato in ~mezzo secondo)
+    params.budget     = m_emissionBudget > 0 ? m_emissionBudget : qMax(1, (count + 29) / 30);
+    params.burstCount = qMin(m_burstPending.load(), MAX_PARTICLES);
+    params.burstX     = static_cast<float>(m_burstPos.x());
+    params.burstY     = static_cast<float>(m_burstPos.y());
+    fillStepParams(params, lod, window() ? static_cast<float>(window()->devicePixelRatio()) : 1.0f);
+
+    if (m_recorder.isOpen())
+        m_recorder.record(params);
+
+    if (!m_stepNotifier) {
+        m_simulationPending = false;
+        return;
+    }
+
+    // Job e buffer vertici sono persistenti: il dispatch non alloca
+    m_stepJob.params = params;
+    m_stepTimed      = true;
+    SimulationWorker::instance().submit(&m_stepJob);
+}
+
+// Un campione di input per step (coordinate item): tocchi, cursore in hover,
+// mousePos da QML; solo i punti dentro l'item.
+int TaoNew::collectAttractors(QPointF *out) const
+{
+    const qreal w = width();
+    const qreal h = height();
+    int n = 0;
+    auto add = [&](const QPointF &pt) {
+        if (n == SimulationParams::MAX_ATTRACTORS)
+            return;
+        if (pt.x() < 0 || pt.x() > w || pt.y() < 0 || pt.y() > h)
+            return;
+        out[n++] = pt;
+    };
+    for (int t = 0; t < m_touchCount; ++t)
+        add(m_touchPoints[t]);
+    if (m_hoverActive)
+        add(m_hoverPos);
+    add(m_mousePos);
+    return n;
+}
+
+// Aspetto, ostacoli e flusso: comuni a simulazione privata e condivisa.
+// `dpr` finisce nella size dei vertici: 1 nella condivisa, dove gli schermi
+// possono avere DPR diversi e lo applicano ciascuno nel cull.
+void TaoNew::fillStepParams(SimulationParams &params, const LodLevel &lod, float dpr) const
+{
+    params.color1[0]  = static_cast<quint8>(m_particleColor1.red());
+    params.color1[1]  = static_cast<quint8>(m_particleColor1.green());
+    params.color1[2]  = static_cast<quint8>(m_particleColor1.blue());
+    params.color2[0]  = static_cast<quint8>(m_particleColor2.red());
+    params.color2[1]  = static_cast<quint8>(m_particleColor2.green());
+    params.color2[2]  = static_cast<quint8>(m_particleColor2.blue());
+    params.size       = static_cast<float>(m_particleSize);
+    params.sizeRandom = static_cast<float>(m_particleSizeRandom);
+    // HiDPI e LOD confluiscono in un unico fattore sulla dimensione sprite
+    params.spriteScale = dpr * lod.sizeScale;
+
+    // Ostacoli: le lancette contano solo se l'orologio è visibile
+    params.obstacleFlags = static_cast<quint32>(m_obstacleShapes);
+    if (!m_showClock)
+        params.obstacleFlags &= ~quint32(ObstacleHands);
+    params.taoRotation = m_rotation;
+    for (int k = 0; k < 3; ++k)
+        params.handAngle[k] = m_handAngle[k];
+
+    // Flusso: il vortice gira nello stesso verso del Tao
+    params.flowStrength = m_flowEnabled ? static_cast<float>(m_flowStrength) : 0.0f;
+    params.flowScale    = static_cast<float>(m_flowScale);
+    params.flowSwirl    = static_cast<float>(m_flowSwirl) * (m_clockwise ? 1.0f : -1.0f);
+}
+
+// ═════════════════════════════════════════════════════════════════════════════
+// updateSharedSimulation  (sync, render thread)
+// ═════════════════════════════════════════════════════════════════════════════
+// Ogni item registra viewport e input, copia le particelle del proprio
+// viewport dall'ultimo stato pubblicato e prova ad avanzare la simulazione:
+// il primo che ci riesce paga lo step per tutti gli schermi.
+// Registrazione e maschera ostacoli restano della modalità privata.
+
+QRectF TaoNew::viewportRect() const
+{
+    return QRectF(m_viewport.topLeft(), size());
+}
+
+QRectF TaoNew::sceneRect() const
+{
+    const QRectF own(QPointF(0, 0), size());
+    if (!m_shared)
+        return own;
+    const QRectF space = m_shared->bounds();
+    return space.isEmpty() ? own : space.translated(-m_viewport.topLeft());
+}
+
+void TaoNew::updateSharedSimulation()
+{
+    const QRectF view = viewportRect();
+
+    QPointF attractors[SimulationParams::MAX_ATTRACTORS];
+    const int nAttractors = collectAttractors(attractors);
+    for (int a = 0; a < nAttractors; ++a)
+        attractors[a] += view.topLeft();
+    m_shared->setView(this, view, attractors, nAttractors);
+
+    if (m_shared->generation() != m_sharedGeneration) {
+        // Margine: lo sprite più grande possibile, in unità item
+        TraceSpan cullSpan("cull");
+        const float margin = static_cast<float>(m_particleSize + m_particleSizeRandom);
+        const float dpr    = window() ? static_cast<float>(window()->devicePixelRatio()) : 1.0f;
+        const int   n      = m_shared->cull(view, margin, dpr, m_verticesRender.data(), &m_sharedGeneration);
+        for (int k = n; k < m_renderActiveCount; ++k)
+            m_verticesRender[k].size = 0.0f;
+        m_renderActiveCount = n;
+
+        // Durata dello step condiviso, chiunque l'abbia accodato
+        if (m_timingActive) {
+            m_stepSum += static_cast<double>(m_shared->lastStepNsecs()) / 1e6;
+            ++m_stepSamples;
         }
+    }
 
-        // Nasconde le particelle oltre il contatore attivo corrente
-        for (int i = count; i < MAX_PARTICLES; ++i)
-            vData[i].size = 0.0f;
+    // Popolazione e LOD sull'intero spazio condiviso
+    const QRectF   space = m_shared->bounds();
+    const LodLevel lod   = computeLod(space.width(), space.height());
+    const int count = m_particleCount > 0
+        ? qMax(1, qRound(m_particleCount * lod.countScale))
+        : 0;
+
+    SimulationParams params;
+    params.count      = count;
+    params.budget     = m_emissionBudget > 0 ? m_emissionBudget : qMax(1, (count + 29) / 30);
+    params.burstCount = qMin(m_burstPending.load(), MAX_PARTICLES);
+    params.burstX     = static_cast<float>(m_burstPos.x() + view.left());
+    params.burstY     = static_cast<float>(m_burstPos.y() + view.top());
+    fillStepParams(params, lod, 1.0f);
+    params.obstacleFlags &= ~quint32(ObstacleMask);
+
+    const float rotationRate = m_rotationSpeed * 0.06f * (m_clockwise ? 1.0f : -1.0f);
+    if (m_shared->advance(params, rotationRate))
+        m_sharedSubmitted = true;
+}
 
-        m_pendingActiveCount.store(count);
-    });
+// ═════════════════════════════════════════════════════════════════════════════
+// requestTextures  (asincrono, worker thread)
+// ═════════════════════════════════════════════════════════════════════════════
 
-    m_watcher.setFuture(future);
+void TaoNew::requestTextures(int taoPx, int glowPx)
+{
+    if (m_textureJobPending) return;
+    m_textureJobPending = true;
+    m_taoTexPx  = taoPx;
+    m_glowTexPx = glowPx;
+
+    const QColor gc1 = m_glowColor1;
+    const QColor gc2 = m_glowColor2;
+
+    m_textureWatcher.setFuture(QtConcurrent::run([gc1, gc2, taoPx, glowPx]() {
+        TaoTrace::nameThread("texture pool");
+        TraceSpan span("texture generate");
+        TaoTextureSet set;
+        set.tao        = generateTaoTexture(taoPx);
+        set.glow1      = generateGlowTexture(glowPx, gc1);
+        set.glow2      = generateGlowTexture(glowPx, gc2);
+        set.glowColor1 = gc1;
+        set.glowColor2 = gc2;
+        set.taoPx      = taoPx;
+        set.glowPx     = glowPx;
+        return set;
+    }));
 }
 
 // ═════════════════════════════════════════════════════════════════════════════
@@ -466,9 +956,39 @@ QSGNode *TaoNew::updatePaintNode(QSGNode *oldNode, UpdatePaintNodeData *)
     QSGNode *root    = oldNode;
     const qreal dpr  = window() ? window()->devicePixelRatio() : 1.0;
 
+    TaoTrace::nameThread("scene graph render");
+    TraceSpan syncSpan("sync");
+
+    // Tempi: il flag viene copiato qui, a GUI thread bloccato
+    const bool timingWasActive = m_timingActive;
+    m_timingActive = m_timingEnabled;
+    QElapsedTimer syncTimer;
+    if (m_timingActive) {
+        syncTimer.start();
+        if (!timingWasActive) {
+            m_timingWindowStart = m_timeTracker.elapsed();
+            m_syncSum = m_stepSum = m_gpuSum = 0.0;
+            m_syncSamples = m_stepSamples = m_gpuSamples = m_gpuFrames = 0;
+            m_gpuUnsupported = false;
+            m_gpuTimingStatus = static_cast<int>(GpuTiming::Pending);
+            QMetaObject::invokeMethod(this, &TaoNew::timingsChanged, Qt::QueuedConnection);
+        }
+    } else if (timingWasActive) {
+        m_gpuFrameTime = -1.0;
+        m_cpuSyncTime  = -1.0;
+        m_cpuStepTime  = -1.0;
+        m_gpuTimingStatus = static_cast<int>(GpuTiming::Off);
+        QMetaObject::invokeMethod(this, &TaoNew::timingsChanged, Qt::QueuedConnection);
+    }
+
     // ── Creazione albero nodi (eseguita una sola volta) ────────────────────────
     if (!root) {
         root = new QSGNode();
+        m_trailNode  = nullptr;   // l'eventuale albero precedente è già stato distrutto
+        m_rasterNode    = nullptr;
+        m_rasterTexture = nullptr;
+        m_rasterPaint   = nullptr;
+        m_softwareActive = false;
 
         // Particelle
         m_particleNode = new QSGGeometryNode();
@@ -489,25 +1009,24 @@ QSGNode *TaoNew::updatePaintNode(QSGNode *oldNode, UpdatePaintNodeData *)
         m_taoRotNode = new QSGTransformNode();
         m_systemNode->appendChildNode(m_taoRotNode);
 
-        // Glow 1
-        m_glowNode1 = new QSGSimpleTextureNode();
-        m_glowNode1->setTexture(window()->createTextureFromImage(generateGlowTexture(256, m_glowColor1, dpr)));
-        m_glowNode1->setOwnsTexture(true);
-        m_glowNode1->setFiltering(QSGTexture::Linear);
+        // Glow e Tao: segnaposto a bassa risoluzione, rasterizzati in pochi µs.
+        // Le versioni definitive vengono generate in background (requestTextures).
+        auto createImageNode = [this](const QImage &img) {
+            QSGImageNode *n = window()->createImageNode();
+            n->setTexture(createMipmappedTexture(window(), img));
+            n->setOwnsTexture(true);
+            n->setFiltering(QSGTexture::Linear);
+            n->setMipmapFiltering(QSGTexture::Linear);
+            return n;
+        };
+
+        m_glowNode1 = createImageNode(generateGlowTexture(PLACEHOLDER_GLOW_SIZE, m_glowColor1));
         m_taoRotNode->appendChildNode(m_glowNode1);
 
-        // Glow 2
-        m_glowNode2 = new QSGSimpleTextureNode();
-        m_glowNode2->setTexture(window()->createTextureFromImage(generateGlowTexture(256, m_glowColor2, dpr)));
-        m_glowNode2->setOwnsTexture(true);
-        m_glowNode2->setFiltering(QSGTexture::Linear);
+        m_glowNode2 = createImageNode(generateGlowTexture(PLACEHOLDER_GLOW_SIZE, m_glowColor2));
         m_taoRotNode->appendChildNode(m_glowNode2);
 
-        // Tao
-        m_taoNode = new QSGSimpleTextureNode();
-        m_taoNode->setTexture(window()->createTextureFromImage(generateTaoTexture(1024, dpr)));
-        m_taoNode->setOwnsTexture(true);
-        m_taoNode->setFiltering(QSGTexture::Linear);
+        m_taoNode = createImageNode(generateTaoTexture(PLACEHOLDER_TAO_SIZE));
         m_taoRotNode->appendChildNode(m_taoNode);
 
         // Lancette orologio
@@ -531,7 +1050,18 @@ QSGNode *TaoNew::updatePaintNode(QSGNode *oldNode, UpdatePaintNodeData *)
         m_clockGroup->appendChildNode(createHand(3.0f, m_minuteHandColor));
         m_clockGroup->appendChildNode(createHand(1.5f, m_secondHandColor));
 
-        m_lastDpr = dpr;
+        m_lastGlowColor1 = m_glowColor1;
+        m_lastGlowColor2 = m_glowColor2;
+        m_taoTexPx  = 0;
+        m_glowTexPx = 0;
+        m_layoutScene = QRectF();
+
+        // Metrica: tempo dalla costruzione al primo frame effettivamente presentato
+        connect(window(), &QQuickWindow::frameSwapped, this, [this]() {
+            m_firstFrameTime = static_cast<double>(m_timeTracker.nsecsElapsed()) / 1e6;
+            qCDebug(lcTao) << "first frame after" << m_firstFrameTime.load() << "ms";
+            QMetaObject::invokeMethod(this, &TaoNew::firstFrameTimeChanged, Qt::QueuedConnection);
+        }, static_cast<Qt::ConnectionType>(Qt::DirectConnection | Qt::SingleShotConnection));
     }
 
     // ── Timing ────────────────────────────────────────────────────────────────
@@ -545,18 +1075,23 @@ QSGNode *TaoNew::updatePaintNode(QSGNode *oldNode, UpdatePaintNodeData *)
     m_rotation += m_rotationSpeed * 0.06f * dir * m_lastDt;
 
     // ── Layout ────────────────────────────────────────────────────────────────
-    const float w = width();
-    const float h = height();
-    const float r = qMin(w, h) / 4.5f;
-
-    QMatrix4x4 sysM;
-    sysM.translate(w * 0.5f, h * 0.5f);
-    m_systemNode->setMatrix(sysM);
+    // Scena: l'item, o lo spazio condiviso visto dal proprio viewport (il Tao
+    // sta al centro dello spazio e può cadere su un altro schermo)
+    const QRectF scene = sceneRect();
+    const float  r     = static_cast<float>(qMin(scene.width(), scene.height())) / 4.5f;
+
+    // Solo al resize: setMatrix() marca sporco tutto il sottoalbero
+    if (m_layoutScene != scene) {
+        m_layoutScene = scene;
+        QMatrix4x4 sysM;
+        sysM.translate(static_cast<float>(scene.center().x()), static_cast<float>(scene.center().y()));
+        m_systemNode->setMatrix(sysM);
+    }
 
     // ── Texture sostituzione sicura ───────────────────────────────────────────
     // N.B.: la texture precedente viene eliminata qui, lato render thread,
     // dove il driver ha già completato il frame che la usava.
-    auto replaceTexture = [this](QSGSimpleTextureNode *node, QSGTexture *newTex) {
+    auto replaceTexture = [](QSGImageNode *node, QSGTexture *newTex) {
         QSGTexture *old = node->texture();
         node->setOwnsTexture(false);
         node->setTexture(newTex);
@@ -564,22 +1099,95 @@ QSGNode *TaoNew::updatePaintNode(QSGNode *oldNode, UpdatePaintNodeData *)
         delete old;
     };
 
-    const bool dprChanged = !qFuzzyCompare(dpr, m_lastDpr);
-    if (dprChanged) {
-        replaceTexture(m_taoNode,   window()->createTextureFromImage(generateTaoTexture(1024, dpr)));
-        replaceTexture(m_glowNode1, window()->createTextureFromImage(generateGlowTexture(256, m_glowColor1, dpr)));
-        replaceTexture(m_glowNode2, window()->createTextureFromImage(generateGlowTexture(256, m_glowColor2, dpr)));
-        m_lastGlowColor1 = m_glowColor1;
-        m_lastGlowColor2 = m_glowColor2;
-        m_lastDpr = dpr;
+    // Dimensioni texture sul raggio a schermo (pixel fisici): un'icona da
+    // pannello non rasterizza più un Tao da 1024 px. I glow sono gradienti
+    // morbidi: bastano metà dei pixel del rettangolo su cui sono stesi.
+    const float glowScale = static_cast<float>(qMax(0.5, qMax(m_glowSize1, m_glowSize2)));
+    const int   wantTaoPx  = textureBucket(2.0f * r * dpr, MIN_TAO_TEXTURE, MAX_TAO_TEXTURE);
+    const int   wantGlowPx = textureBucket(r * glowScale * dpr, MIN_GLOW_TEXTURE, MAX_GLOW_TEXTURE);
+
+    // ── Backend software ──────────────────────────────────────────────────────
+    // Senza QRhi i materiali custom non vengono disegnati: l'intera scena
+    // passa dal raster su CPU, in un solo image node sopra gli altri (vuoti).
+    const bool software = m_softwareRendering || !window()->rhi();
+    if (software != m_softwareActive) {
+        m_softwareActive = software;
+        if (software) {
+            // Con QRhi una texture che riceve solo i rettangoli ridisegnati;
+            // senza, l'immagine va dritta al QPainter del renderer
+            if (window()->rhi()) {
+                QSGImageNode *node = window()->createImageNode();
+                m_rasterTexture = new RasterTexture(m_raster);
+                node->setTexture(m_rasterTexture);
+                node->setOwnsTexture(true);
+                node->setFiltering(QSGTexture::Nearest);
+                m_rasterNode = node;
+            } else {
+                m_rasterPaint = new RasterPaintNode(window(), m_raster);
+                m_rasterNode  = m_rasterPaint;
+            }
+            root->appendChildNode(m_rasterNode);
+            m_raster.resize(0, 0);
+            m_raster.setTaoImage(generateTaoTexture(PLACEHOLDER_TAO_SIZE));
+            m_raster.setGlowImage(0, generateGlowTexture(PLACEHOLDER_GLOW_SIZE, m_glowColor1));
+            m_raster.setGlowImage(1, generateGlowTexture(PLACEHOLDER_GLOW_SIZE, m_glowColor2));
+        } else {
+            root->removeChildNode(m_rasterNode);
+            delete m_rasterNode;
+            m_rasterNode    = nullptr;
+            m_rasterTexture = nullptr;
+            m_rasterPaint   = nullptr;
+        }
+        // Texture definitive verso la destinazione del nuovo modo (un job già
+        // in corso consegna comunque lì)
+        if (!m_textureJobPending)
+            requestTextures(wantTaoPx, wantGlowPx);
+    }
+
+    auto setTaoImage = [&](const QImage &img) {
+        if (m_softwareActive) m_raster.setTaoImage(img);
+        else                  replaceTexture(m_taoNode, createMipmappedTexture(window(), img));
+    };
+    auto setGlowImage = [&](int index, const QImage &img) {
+        if (m_softwareActive) m_raster.setGlowImage(index, img);
+        else                  replaceTexture(index == 0 ? m_glowNode1 : m_glowNode2,
+                                             createMipmappedTexture(window(), img));
+    };
+
+    // Texture definitive pronte: sostituiscono i segnaposto (o la versione
+    // a risoluzione precedente). Un glow il cui colore è cambiato nel
+    // frattempo viene lasciato al ramo sincrono sottostante.
+    if (m_texturesReady) {
+        m_texturesReady = false;
+        TraceSpan uploadSpan("texture upload");
+        const TaoTextureSet set = m_textureWatcher.result();
+        setTaoImage(set.tao);
+        if (set.glowColor1 == m_glowColor1) {
+            setGlowImage(0, set.glow1);
+            m_lastGlowColor1 = set.glowColor1;
+        }
+        if (set.glowColor2 == m_glowColor2) {
+            setGlowImage(1, set.glow2);
+            m_lastGlowColor2 = set.glowColor2;
+        }
+        if (m_fullQualityTime.load() < 0.0) {
+            m_fullQualityTime = static_cast<double>(m_timeTracker.nsecsElapsed()) / 1e6;
+            qCDebug(lcTao) << "full-resolution textures after" << m_fullQualityTime.load() << "ms";
+            QMetaObject::invokeMethod(this, &TaoNew::fullQualityTimeChanged, Qt::QueuedConnection);
+        }
     }
 
+    // Cambio di dimensione/DPR: le texture correnti restano visibili finché
+    // il worker non consegna quelle nuove.
+    if ((wantTaoPx != m_taoTexPx || wantGlowPx != m_glowTexPx) && !m_textureJobPending)
+        requestTextures(wantTaoPx, wantGlowPx);
+
     // Aggiorna glow 1
     {
         const float gs = static_cast<float>(m_glowSize1);
-        m_glowNode1->setRect(gs > 0.01f ? QRectF(-r*gs, -r*gs, r*2*gs, r*2*gs) : QRectF());
-        if (!dprChanged && m_lastGlowColor1 != m_glowColor1) {
-            replaceTexture(m_glowNode1, window()->createTextureFromImage(generateGlowTexture(256, m_glowColor1, dpr)));
+        m_glowNode1->setRect(gs > 0.01f && !software ? QRectF(-r*gs, -r*gs, r*2*gs, r*2*gs) : QRectF());
+        if (m_lastGlowColor1 != m_glowColor1) {
+            setGlowImage(0, generateGlowTexture(m_glowTexPx, m_glowColor1));
             m_lastGlowColor1 = m_glowColor1;
         }
     }
@@ -587,18 +1195,18 @@ QSGNode *TaoNew::updatePaintNode(QSGNode *oldNode, UpdatePaintNodeData *)
     // Aggiorna glow 2
     {
         const float gs = static_cast<float>(m_glowSize2);
-        m_glowNode2->setRect(gs > 0.01f ? QRectF(-r*gs, -r*gs, r*2*gs, r*2*gs) : QRectF());
-        if (!dprChanged && m_lastGlowColor2 != m_glowColor2) {
-            replaceTexture(m_glowNode2, window()->createTextureFromImage(generateGlowTexture(256, m_glowColor2, dpr)));
+        m_glowNode2->setRect(gs > 0.01f && !software ? QRectF(-r*gs, -r*gs, r*2*gs, r*2*gs) : QRectF());
+        if (m_lastGlowColor2 != m_glowColor2) {
+            setGlowImage(1, generateGlowTexture(m_glowTexPx, m_glowColor2));
             m_lastGlowColor2 = m_glowColor2;
         }
     }
 
-    m_taoNode->setRect(-r, -r, r*2, r*2);
+    m_taoNode->setRect(software ? QRectF() : QRectF(-r, -r, r*2, r*2));
 
     // ── Rotazione Tao ─────────────────────────────────────────────────────────
     QMatrix4x4 tM;
-    tM.rotate(qRadiansToDegrees(m_rotation), 0, 0, 1);
+    tM.rotate(qRadiansToDegrees(m_shared ? m_shared->rotation() : m_rotation), 0, 0, 1);
     m_taoRotNode->setMatrix(tM);
 
     // ── Orologio ──────────────────────────────────────────────────────────────
@@ -625,10 +1233,18 @@ QSGNode *TaoNew::updatePaintNode(QSGNode *oldNode, UpdatePaintNodeData *)
             }
         };
 
-        updateHand(0, hr,  r * 0.5f, m_hourHandColor);
-        updateHand(1, min, r * 0.8f, m_minuteHandColor);
-        updateHand(2, sec, r * 0.9f, m_secondHandColor);
-    } else {
+        if (!software) {
+            updateHand(0, hr,  r * 0.5f, m_hourHandColor);
+            updateHand(1, min, r * 0.8f, m_minuteHandColor);
+            updateHand(2, sec, r * 0.9f, m_secondHandColor);
+        }
+
+        // Stessi angoli per le lancette-ostacolo (e per il raster su CPU)
+        m_handAngle[0] = qDegreesToRadians(hr  - 90.0f);
+        m_handAngle[1] = qDegreesToRadians(min - 90.0f);
+        m_handAngle[2] = qDegreesToRadians(sec - 90.0f);
+    }
+    if (!m_showClock || software) {
         // Nasconde le lancette senza deallocare
         for (int i = 0; i < 3; ++i) {
             auto *hn = static_cast<QSGGeometryNode*>(m_clockGroup->childAtIndex(i));
@@ -639,33 +1255,248 @@ QSGNode *TaoNew::updatePaintNode(QSGNode *oldNode, UpdatePaintNodeData *)
         }
     }
 
+    // ── Scie (feedback buffer) ────────────────────────────────────────────────
+    // Richiede QRhi: con il backend software la modalità resta disattivata.
+    const bool trailActive = m_trailEnabled && window()->rhi() && !software;
+    if (trailActive && !m_trailNode) {
+        m_trailNode = new TrailNode(window(), MAX_PARTICLES);
+        root->prependChildNode(m_trailNode);   // sotto particelle e Tao
+    } else if (!trailActive && m_trailNode) {
+        root->removeChildNode(m_trailNode);
+        delete m_trailNode;
+        m_trailNode = nullptr;
+    }
+
     // ── Particelle ────────────────────────────────────────────────────────────
     // Buffer fisso MAX_PARTICLES: nessuna riallocazione driver tra i frame.
     // Le particelle inattive hanno size=0 e vengono scartate dalla GPU.
+    // In modalità scia le particelle vengono disegnate solo nel feedback buffer.
     QSGGeometry *pGeo = m_particleNode->geometry();
-    if (pGeo->vertexCount() != MAX_PARTICLES)
-        pGeo->allocate(MAX_PARTICLES);
+    const int drawnVertices = (trailActive || software) ? 0 : MAX_PARTICLES;
+    if (pGeo->vertexCount() != drawnVertices) {
+        pGeo->allocate(drawnVertices);
+        if (drawnVertices > 0)
+            std::memcpy(pGeo->vertexData(), m_verticesRender.data(),
+                        static_cast<size_t>(MAX_PARTICLES) * sizeof(ParticleVertex));
+        m_geometryVisible = m_renderActiveCount;
+        m_particleNode->markDirty(QSGNode::DirtyGeometry);
+    }
 
-    if (!m_simulationPending) {
+    if (m_trailNode) {
+        m_trailNode->setItemSize(size(), dpr);
+        m_trailNode->setResolution(static_cast<float>(m_trailResolution));
+        m_trailNode->setDecay(static_cast<float>(m_trailDecay));
+        m_trailNode->setFrameTime(m_lastDt);
+        if (!m_simulationPending)
+            m_trailNode->setParticles(m_verticesRender.data(), m_renderActiveCount);
+        m_trailNode->markDirty(QSGNode::DirtyMaterial);
+    } else if (software) {
+        // Step in corso: il worker scrive nel buffer, l'immagine resta quella
+        // del frame precedente fino al prossimo step concluso
+        if (!m_simulationPending)
+            renderSoftware(scene, r, dpr);
+    } else if (!m_simulationPending) {
+        // Solo il prefisso vivo più gli slot spenti in questo step: il resto
+        // del buffer ha già size=0 dai frame precedenti.
+        TraceSpan copySpan("vertex copy");
+        const int copyCount = qMax(m_renderActiveCount, m_geometryVisible);
         std::memcpy(pGeo->vertexData(),
                     m_verticesRender.data(),
-                    static_cast<size_t>(MAX_PARTICLES) * sizeof(ParticleVertex));
+                    static_cast<size_t>(copyCount) * sizeof(ParticleVertex));
+        m_geometryVisible = m_renderActiveCount;
         m_particleNode->markDirty(QSGNode::DirtyGeometry);
     }
+    // Step privato ancora sul worker: il frame ridisegna i vertici precedenti
+    if (m_simulationPending)
+        TaoTrace::instant("upload skipped");
+    TaoTrace::counter("particles", m_renderActiveCount);
 
     updateSimulation();
+
+    if (m_timingActive) {
+        m_syncSum += static_cast<double>(syncTimer.nsecsElapsed()) / 1e6;
+        ++m_syncSamples;
+        sampleGpuTime(window());
+        publishTimings(now);
+    }
     return root;
 }
 
+// ═════════════════════════════════════════════════════════════════════════════
+// renderSoftware  (render thread)
+// ═════════════════════════════════════════════════════════════════════════════
+
+// Stessa scena dei nodi GPU, in pixel fisici. Senza tile sporchi (scena
+// ferma) l'image node conserva la texture del frame precedente.
+void TaoNew::renderSoftware(const QRectF &scene, float r, qreal dpr)
+{
+    TraceSpan span("software raster");
+    m_raster.resize(qCeil(width() * dpr), qCeil(height() * dpr));
+
+    static constexpr float HAND_LENGTH[3] = { 0.5f, 0.8f, 0.9f };
+    static constexpr float HAND_WIDTH[3]  = { 5.0f, 3.0f, 1.5f };
+    const QColor handColor[3] = { m_hourHandColor, m_minuteHandColor, m_secondHandColor };
+
+    const float scale = static_cast<float>(dpr);
+    SoftwareScene frame;
+    frame.center      = scene.center() * dpr;
+    frame.radius      = r * scale;
+    frame.rotation    = m_shared ? m_shared->rotation() : m_rotation;
+    frame.glowSize[0] = static_cast<float>(m_glowSize1);
+    frame.glowSize[1] = static_cast<float>(m_glowSize2);
+    frame.showClock   = m_showClock;
+    for (int h = 0; h < 3; ++h) {
+        frame.handAngle[h]  = m_handAngle[h];
+        frame.handLength[h] = r * HAND_LENGTH[h] * scale;
+        frame.handWidth[h]  = HAND_WIDTH[h] * scale;
+        frame.handColor[h]  = handColor[h];
+    }
+    frame.particles     = m_verticesRender.data();
+    frame.particleCount = m_renderActiveCount;
+    frame.positionScale = scale;
+
+    // Nessuna texture ricreata: quella persistente carica il solo rettangolo
+    // ridisegnato al commit del frame, il nodo QPainter ridisegna l'immagine
+    const QRect  dirty = m_raster.render(frame);
+    const QRectF rect(0, 0, m_raster.size().width() / dpr, m_raster.size().height() / dpr);
+    if (m_rasterTexture) {
+        auto *node = static_cast<QSGImageNode *>(m_rasterNode);
+        if (node->rect() != rect)
+            node->setRect(rect);
+        if (!dirty.isEmpty()) {
+            m_rasterTexture->addDirtyRect(dirty);
+            node->markDirty(QSGNode::DirtyMaterial);
+        }
+    } else if (!dirty.isEmpty() || m_rasterPaint->rect() != rect) {
+        m_rasterPaint->setRect(rect);
+        m_rasterPaint->markDirty(QSGNode::DirtyMaterial | QSGNode::DirtyGeometry);
+    }
+}
+
+// ═════════════════════════════════════════════════════════════════════════════
+// Tempi per frame  (render thread)
+// ═════════════════════════════════════════════════════════════════════════════
+
+// Chiamato dal sync, a frame già iniziato (beginFrame precede la sync): il
+// valore disponibile è quello dell'ultimo frame concluso dalla GPU (uno o due
+// frame indietro). Niente afterRendering: la connessione diretta girerebbe sul
+// render thread anche dopo la distruzione dell'item. QRhi espone solo il tempo
+// dell'intero command buffer: il costo dei singoli passaggi non è separabile.
+void TaoNew::sampleGpuTime(QQuickWindow *window)
+{
+    if (!m_timingActive)
+        return;
+
+    QRhi *rhi = window->rhi();
+    QRhiSwapChain *swapChain = window->swapChain();
+    if (!rhi || !swapChain || !rhi->isFeatureSupported(QRhi::Timestamps)) {
+        m_gpuUnsupported = true;
+        return;
+    }
+
+    ++m_gpuFrames;
+    QRhiCommandBuffer *cb = swapChain->currentFrameCommandBuffer();
+    const double seconds = cb ? cb->lastCompletedGpuTime() : 0.0;
+    if (seconds > 0.0) {
+        m_gpuSum += seconds * 1000.0;
+        ++m_gpuSamples;
+    }
+}
+
+void TaoNew::publishTimings(qint64 now)
+{
+    if (now - m_timingWindowStart < TIMING_WINDOW_MS)
+        return;
+    m_timingWindowStart = now;
+
+    m_cpuSyncTime  = m_syncSamples > 0 ? m_syncSum / m_syncSamples : -1.0;
+    m_cpuStepTime  = m_stepSamples > 0 ? m_stepSum / m_stepSamples : -1.0;
+    m_gpuFrameTime = m_gpuSamples  > 0 ? m_gpuSum  / m_gpuSamples  : -1.0;
+
+    // Timestamp supportati ma mai valorizzati in un'intera finestra: QRhi
+    // creato senza EnableTimestamps (QSG_RHI_PROFILE non impostata)
+    GpuTiming status = GpuTiming::Pending;
+    if (m_gpuUnsupported)
+        status = GpuTiming::Unsupported;
+    else if (m_gpuSamples > 0)
+        status = GpuTiming::Ok;
+    else if (m_gpuFrames > 0)
+        status = GpuTiming::Inactive;
+    m_gpuTimingStatus = static_cast<int>(status);
+
+    qCDebug(lcTao).nospace() << "timings: gpu " << m_gpuFrameTime.load()
+                             << " ms, sync " << m_cpuSyncTime.load()
+                             << " ms, step " << m_cpuStepTime.load()
+                             << " ms (" << gpuTimingStatus() << ")";
+
+    m_syncSum = m_stepSum = m_gpuSum = 0.0;
+    m_syncSamples = m_stepSamples = m_gpuSamples = m_gpuFrames = 0;
+    m_gpuUnsupported = false;
+    QMetaObject::invokeMethod(this, &TaoNew::timingsChanged, Qt::QueuedConnection);
+}
+
+// ═════════════════════════════════════════════════════════════════════════════
+// requestObstacleMask / loadObstacleMask  (asincrono, worker thread)
+// ═════════════════════════════════════════════════════════════════════════════
+
+void TaoNew::requestObstacleMask(int gw, int gh)
+{
+    if (m_maskJobPending) return;
+    m_maskJobPending  = true;
+    m_maskRequestPath = m_obstacleMask;
+    m_maskRequestW    = gw;
+    m_maskRequestH    = gh;
+
+    const QString path = m_obstacleMask;
+    m_maskWatcher.setFuture(QtConcurrent::run([path, gw, gh]() {
+        TaoTrace::nameThread("texture pool");
+        TraceSpan span("mask load");
+        return loadObstacleMask(path, gw, gh);
+    }));
+}
+
+// L'immagine viene ridotta direttamente alla griglia del campo (per gli SVG
+// il renderer rasterizza già a quella dimensione). Pieno = pixel opaco, o
+// scuro per immagini senza canale alpha.
+ObstacleMaskData TaoNew::loadObstacleMask(const QString &path, int gw, int gh)
+{
+    ObstacleMaskData data;
+    data.path = path;
+
+    const QUrl url(path);
+    QImageReader reader(url.isLocalFile() ? url.toLocalFile() : path);
+    reader.setScaledSize(QSize(gw, gh));
+    const QImage img = reader.read();
+    if (img.isNull()) {
+        qCWarning(lcTao) << "cannot load obstacle mask" << path << reader.errorString();
+        return data;
+    }
+
+    const QImage argb   = img.convertToFormat(QImage::Format_ARGB32);
+    const bool   alpha  = img.hasAlphaChannel();
+    std::vector<quint8> solid(static_cast<size_t>(gw) * gh);
+    for (int y = 0; y < gh; ++y) {
+        const auto *line = reinterpret_cast<const QRgb *>(argb.constScanLine(y));
+        for (int x = 0; x < gw; ++x)
+            solid[static_cast<size_t>(y) * gw + x] = alpha ? (qAlpha(line[x]) >= 128)
+                                                            : (qGray(line[x]) < 128);
+    }
+
+    data.distance.resize(solid.size());
+    ObstacleField::maskDistance(solid.data(), gw, gh, data.distance.data());
+    data.gw = gw;
+    data.gh = gh;
+    return data;
+}
+
 // ═════════════════════════════════════════════════════════════════════════════
 // generateGlowTexture
 // ═════════════════════════════════════════════════════════════════════════════
 
-QImage TaoNew::generateGlowTexture(int size, const QColor &color, qreal dpr)
+QImage TaoNew::generateGlowTexture(int px, const QColor &color)
 {
-    const int phys = qRound(size * dpr);
+    const int phys = qMax(1, px);
     QImage img(phys, phys, QImage::Format_ARGB32_Premultiplied);
-    img.setDevicePixelRatio(dpr);
     img.fill(Qt::transparent);
 
     QRadialGradient g(phys * 0.5, phys * 0.5, phys * 0.5);
@@ -686,14 +1517,14 @@ QImage TaoNew::generateGlowTexture(int size, const QColor &color, qreal dpr)
 // generateTaoTexture
 // ═════════════════════════════════════════════════════════════════════════════
 
-QImage TaoNew::generateTaoTexture(int size, qreal dpr)
+QImage TaoNew::generateTaoTexture(int px)
 {
-    const int   phys = qRound(size * dpr);
+    const int   phys = qMax(1, px);
     const float c    = phys * 0.5f;
-    const float r    = c - 2.0f * static_cast<float>(dpr);
+    // Bordo trasparente proporzionale (2 px ogni 1024) contro il bleeding
+    const float r    = c - qMax(1.0f, phys / 512.0f);
 
     QImage img(phys, phys, QImage::Format_ARGB32_Premultiplied);
-    img.setDevicePixelRatio(dpr);
     img.fill(Qt::transparent);
 
     QPainter p(&img);
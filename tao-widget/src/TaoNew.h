@@ -6,30 +6,47 @@
 #include <QElapsedTimer>
 #include <QSGNode>
 #include <QSGGeometryNode>
-#include <QSGSimpleTextureNode>
+#include <QSGImageNode>
 #include <QSGTransformNode>
 #include <QSGGeometry>
 #include <QSGMaterial>
 #include <QSGMaterialShader>
 #include <QSGTexture>
+#include <QImage>
+#include <QTimer>
+#include "ParticleSystem.h"
+#include "SharedSimulation.h"
+#include "SimulationWorker.h"
+#include "SoftwareRaster.h"
+#include "TaoReplay.h"
 #include <atomic>
+#include <memory>
 #include <vector>
 
-// ── Strutture dati particelle ─────────────────────────────────────────────────
-
-struct ParticleData {
-    float   x, y;
-    float   vx, vy;
-    float   life;
-    float   decay;
-    float   size;
-    quint32 packedColor;
+class QSocketNotifier;
+class TrailNode;
+class RasterTexture;
+class RasterPaintNode;
+
+// Texture Tao + glow rasterizzate in background; i colori dei glow sono
+// registrati per scartare risultati superati da un cambio colore nel frattempo.
+struct TaoTextureSet {
+    QImage tao;
+    QImage glow1;
+    QImage glow2;
+    QColor glowColor1;
+    QColor glowColor2;
+    int    taoPx  = 0;
+    int    glowPx = 0;
 };
 
-struct ParticleVertex {
-    float   x, y;
-    float   size;
-    quint32 color;
+// Maschera ostacoli già convertita in distanza (celle) sulla griglia gw×gh
+// del campo; `path` scarta risultati superati da un cambio di file.
+struct ObstacleMaskData {
+    std::vector<float> distance;
+    int     gw = 0;
+    int     gh = 0;
+    QString path;
 };
 
 // ── ParticleMaterial ──────────────────────────────────────────────────────────
@@ -55,6 +72,8 @@ class TaoNew : public QQuickItem
     Q_PROPERTY(QColor particleColor2 READ particleColor2 WRITE setParticleColor2 NOTIFY particleColor2Changed)
     Q_PROPERTY(double particleSize   READ particleSize   WRITE setParticleSize   NOTIFY particleSizeChanged)
     Q_PROPERTY(double particleSizeRandom READ particleSizeRandom WRITE setParticleSizeRandom NOTIFY particleSizeRandomChanged)
+    // Nascite massime per step (0 = automatico)
+    Q_PROPERTY(int    emissionBudget READ emissionBudget WRITE setEmissionBudget NOTIFY emissionBudgetChanged)
 
     // Rotazione
     Q_PROPERTY(float rotationSpeed READ rotationSpeed WRITE setRotationSpeed NOTIFY rotationSpeedChanged)
@@ -72,9 +91,68 @@ class TaoNew : public QQuickItem
     Q_PROPERTY(QColor minuteHandColor READ minuteHandColor WRITE setMinuteHandColor NOTIFY minuteHandColorChanged)
     Q_PROPERTY(QColor secondHandColor READ secondHandColor WRITE setSecondHandColor NOTIFY secondHandColorChanged)
 
-    // Input
+    // Determinismo e registrazione dell'input (vedi TaoReplay.h)
+    Q_PROPERTY(int     simulationSeed READ simulationSeed WRITE setSimulationSeed NOTIFY simulationSeedChanged)
+    Q_PROPERTY(double  fixedTimeStep  READ fixedTimeStep  WRITE setFixedTimeStep  NOTIFY fixedTimeStepChanged)
+    Q_PROPERTY(QString recordPath     READ recordPath     WRITE setRecordPath     NOTIFY recordPathChanged)
+
+    // Scie: feedback buffer offscreen; trailDecay è l'attenuazione per 1/60 s
+    Q_PROPERTY(bool   trailEnabled    READ trailEnabled    WRITE setTrailEnabled    NOTIFY trailEnabledChanged)
+    Q_PROPERTY(double trailDecay      READ trailDecay      WRITE setTrailDecay      NOTIFY trailDecayChanged)
+    Q_PROPERTY(double trailResolution READ trailResolution WRITE setTrailResolution NOTIFY trailResolutionChanged)
+
+    // Rasterizzazione su CPU (vedi SoftwareRaster.h): sempre usata con lo
+    // scene graph software (nessun QRhi), qui forzabile anche con la GPU
+    Q_PROPERTY(bool softwareRendering READ softwareRendering WRITE setSoftwareRendering NOTIFY softwareRenderingChanged)
+
+    // Livello di dettaglio (LOD) in base alla dimensione dell'item
+    Q_PROPERTY(bool lodEnabled  READ lodEnabled  WRITE setLodEnabled  NOTIFY lodEnabledChanged)
+    Q_PROPERTY(int  lodFullSize READ lodFullSize WRITE setLodFullSize NOTIFY lodFullSizeChanged)
+    Q_PROPERTY(int  lodMinSize  READ lodMinSize  WRITE setLodMinSize  NOTIFY lodMinSizeChanged)
+
+    // Ostacoli: bit di ObstacleShape (1 = Tao, 2 = puntini, 4 = lancette,
+    // 8 = maschera) e immagine/SVG della maschera, stesa sull'item
+    Q_PROPERTY(int     obstacleShapes READ obstacleShapes WRITE setObstacleShapes NOTIFY obstacleShapesChanged)
+    Q_PROPERTY(QString obstacleMask   READ obstacleMask   WRITE setObstacleMask   NOTIFY obstacleMaskChanged)
+
+    // Flusso ambientale (curl noise): forza in px/frame, dimensione dei vortici
+    // (× lato minore) e vortice attorno al Tao, che segue il verso di rotazione
+    Q_PROPERTY(bool   flowEnabled  READ flowEnabled  WRITE setFlowEnabled  NOTIFY flowEnabledChanged)
+    Q_PROPERTY(double flowStrength READ flowStrength WRITE setFlowStrength NOTIFY flowStrengthChanged)
+    Q_PROPERTY(double flowScale    READ flowScale    WRITE setFlowScale    NOTIFY flowScaleChanged)
+    Q_PROPERTY(double flowSwirl    READ flowSwirl    WRITE setFlowSwirl    NOTIFY flowSwirlChanged)
+
+    // Input: hover e tocco arrivano direttamente all'item (vedi hoverMoveEvent /
+    // touchEvent); mousePos resta come attrattore pilotabile da QML.
     Q_PROPERTY(QPointF mousePos READ mousePos WRITE setMousePos NOTIFY mousePosChanged)
 
+    // Simulazione condivisa (es. sfondo su più schermi): gli item con lo stesso
+    // gruppo simulano una sola volta nello spazio unione dei loro viewport e
+    // disegnano solo le particelle del proprio. viewport = posizione dell'item
+    // in quello spazio (es. geometria dello schermo); vuoto = (0, 0).
+    Q_PROPERTY(QString sharedGroup READ sharedGroup WRITE setSharedGroup NOTIFY sharedGroupChanged)
+    Q_PROPERTY(QRectF  viewport    READ viewport    WRITE setViewport    NOTIFY viewportChanged)
+
+    // Metriche di avvio (ms dalla costruzione, -1 finché non disponibili)
+    Q_PROPERTY(double firstFrameTime  READ firstFrameTime  NOTIFY firstFrameTimeChanged)
+    Q_PROPERTY(double fullQualityTime READ fullQualityTime NOTIFY fullQualityTimeChanged)
+
+    // Tempi per frame (ms, medie su mezzo secondo, -1 = non disponibile), con
+    // timingEnabled o TAO_TIMING=1. Il tempo GPU è l'intero frame della
+    // finestra (timestamp QRhi: richiede QSG_RHI_PROFILE=1 all'avvio).
+    // gpuTimingStatus: "off", "pending", "ok", "inactive" (timestamp non
+    // abilitati), "unsupported" (backend software o senza timestamp).
+    Q_PROPERTY(bool    timingEnabled   READ timingEnabled   WRITE setTimingEnabled NOTIFY timingEnabledChanged)
+    Q_PROPERTY(double  gpuFrameTime    READ gpuFrameTime    NOTIFY timingsChanged)
+    Q_PROPERTY(double  cpuSyncTime     READ cpuSyncTime     NOTIFY timingsChanged)
+    Q_PROPERTY(double  cpuStepTime     READ cpuStepTime     NOTIFY timingsChanged)
+    Q_PROPERTY(QString gpuTimingStatus READ gpuTimingStatus NOTIFY timingsChanged)
+
+    // Traccia temporale Chrome/Perfetto di sync, step, copie e texture (vedi
+    // TaoTrace.h), scritta in tracePath quando viene svuotato o all'uscita.
+    // Anche con TAO_TRACE=/percorso/file.json.
+    Q_PROPERTY(QString tracePath       READ tracePath       WRITE setTracePath     NOTIFY tracePathChanged)
+
 public:
     explicit TaoNew(QQuickItem *parent = nullptr);
     ~TaoNew() override;
@@ -95,7 +173,34 @@ public:
     QColor  secondHandColor() const { return m_secondHandColor; }
     double  particleSize()    const { return m_particleSize; }
     double  particleSizeRandom() const { return m_particleSizeRandom; }
+    int     emissionBudget()  const { return m_emissionBudget; }
+    int     simulationSeed()  const { return m_simulationSeed; }
+    double  fixedTimeStep()   const { return m_fixedTimeStep; }
+    QString recordPath()      const { return m_recordPath; }
+    bool    trailEnabled()    const { return m_trailEnabled; }
+    bool    softwareRendering() const { return m_softwareRendering; }
+    double  trailDecay()      const { return m_trailDecay; }
+    double  trailResolution() const { return m_trailResolution; }
+    bool    lodEnabled()      const { return m_lodEnabled; }
+    int     lodFullSize()     const { return m_lodFullSize; }
+    int     lodMinSize()      const { return m_lodMinSize; }
+    int     obstacleShapes()  const { return m_obstacleShapes; }
+    QString obstacleMask()    const { return m_obstacleMask; }
+    bool    flowEnabled()     const { return m_flowEnabled; }
+    double  flowStrength()    const { return m_flowStrength; }
+    double  flowScale()       const { return m_flowScale; }
+    double  flowSwirl()       const { return m_flowSwirl; }
     QPointF mousePos()        const { return m_mousePos; }
+    QString sharedGroup()     const { return m_sharedGroup; }
+    QRectF  viewport()        const { return m_viewport; }
+    double  firstFrameTime()  const { return m_firstFrameTime.load(); }
+    double  fullQualityTime() const { return m_fullQualityTime.load(); }
+    bool    timingEnabled()   const { return m_timingEnabled; }
+    double  gpuFrameTime()    const { return m_gpuFrameTime.load(); }
+    double  cpuSyncTime()     const { return m_cpuSyncTime.load(); }
+    double  cpuStepTime()     const { return m_cpuStepTime.load(); }
+    QString gpuTimingStatus() const;
+    QString tracePath()       const { return m_tracePath; }
 
     // Setters
     void setParticleCount  (int count);
@@ -113,7 +218,32 @@ public:
     void setSecondHandColor(const QColor &c);
     void setParticleSize(double s);
     void setParticleSizeRandom(double s);
+    void setEmissionBudget (int budget);
+
+    // Emette `count` particelle attorno a `pos`, distribuite sui frame
+    // successivi entro emissionBudget.
+    Q_INVOKABLE void emitBurst(int count, const QPointF &pos);
+    void setSimulationSeed (int seed);
+    void setFixedTimeStep  (double dt);
+    void setRecordPath     (const QString &path);
+    void setTrailEnabled   (bool enabled);
+    void setSoftwareRendering(bool enabled);
+    void setTrailDecay     (double decay);
+    void setTrailResolution(double scale);
+    void setLodEnabled     (bool enabled);
+    void setLodFullSize    (int size);
+    void setLodMinSize     (int size);
+    void setObstacleShapes (int shapes);
+    void setObstacleMask   (const QString &path);
+    void setFlowEnabled    (bool enabled);
+    void setFlowStrength   (double strength);
+    void setFlowScale      (double scale);
+    void setFlowSwirl      (double swirl);
     void setMousePos       (const QPointF &pos);
+    void setSharedGroup    (const QString &group);
+    void setViewport       (const QRectF &rect);
+    void setTimingEnabled  (bool enabled);
+    void setTracePath      (const QString &path);
 
 Q_SIGNALS:
     void particleCountChanged();
@@ -131,20 +261,80 @@ Q_SIGNALS:
     void secondHandColorChanged();
     void particleSizeChanged();
     void particleSizeRandomChanged();
+    void emissionBudgetChanged();
+    void simulationSeedChanged();
+    void fixedTimeStepChanged();
+    void recordPathChanged();
+    void trailEnabledChanged();
+    void softwareRenderingChanged();
+    void trailDecayChanged();
+    void trailResolutionChanged();
+    void lodEnabledChanged();
+    void lodFullSizeChanged();
+    void lodMinSizeChanged();
+    void obstacleShapesChanged();
+    void obstacleMaskChanged();
+    void flowEnabledChanged();
+    void flowStrengthChanged();
+    void flowScaleChanged();
+    void flowSwirlChanged();
     void mousePosChanged();
+    void sharedGroupChanged();
+    void viewportChanged();
+    void firstFrameTimeChanged();
+    void fullQualityTimeChanged();
+    void timingEnabledChanged();
+    void timingsChanged();
+    void tracePathChanged();
 
 protected:
     QSGNode *updatePaintNode(QSGNode *oldNode, UpdatePaintNodeData *) override;
     void     itemChange(ItemChange change, const ItemChangeData &value) override;
+    void     hoverEnterEvent(QHoverEvent *event) override;
+    void     hoverMoveEvent (QHoverEvent *event) override;
+    void     hoverLeaveEvent(QHoverEvent *event) override;
+    void     touchEvent     (QTouchEvent *event) override;
 
 private:
     // ── Costanti ──────────────────────────────────────────────────────────────
     static constexpr int MAX_PARTICLES = 3000;
+    // Segnaposto a bassa risoluzione per il primo frame
+    static constexpr int PLACEHOLDER_TAO_SIZE  = 64;
+    static constexpr int PLACEHOLDER_GLOW_SIZE = 32;
+    // Limiti (pixel fisici) delle texture dimensionate sul raggio a schermo
+    static constexpr int MIN_TAO_TEXTURE  = 32;
+    static constexpr int MAX_TAO_TEXTURE  = 2048;
+    static constexpr int MIN_GLOW_TEXTURE = 16;
+    static constexpr int MAX_GLOW_TEXTURE = 512;
+
+    // Parametri LOD derivati dall'area dell'item
+    struct LodLevel {
+        float countScale    = 1.0f;  // frazione di particleCount simulata
+        float sizeScale     = 1.0f;  // fattore sulla dimensione degli sprite
+        int   frameInterval = 0;     // ms minimi tra due step (0 = vsync)
+    };
 
     // ── Metodi privati ────────────────────────────────────────────────────────
-    void   updateSimulation();
-    QImage generateGlowTexture(int size, const QColor &color, qreal dpr = 1.0);
-    QImage generateTaoTexture (int size, qreal dpr = 1.0);
+    void     updateSimulation();
+    void     updateSharedSimulation();
+    void     fillStepParams(SimulationParams &params, const LodLevel &lod, float dpr) const;
+    int      collectAttractors(QPointF *out) const;
+    QRectF   viewportRect() const;
+    QRectF   sceneRect() const;
+    void     stepFinished();
+    void     sharedStepped();
+    void     lodTick();
+    LodLevel computeLod(float w, float h) const;
+    void     sampleGpuTime(QQuickWindow *window);
+    void     renderSoftware(const QRectF &scene, float r, qreal dpr);
+    void     publishTimings(qint64 now);
+    void     requestTextures(int taoPx, int glowPx);
+    void     requestObstacleMask(int gw, int gh);
+    // Statiche: rasterizzazione pura su QImage, sicura dal worker thread.
+    // `px` è la dimensione in pixel fisici.
+    static QImage generateGlowTexture(int px, const QColor &color);
+    static QImage generateTaoTexture (int px);
+    static ObstacleMaskData loadObstacleMask(const QString &path, int gw, int gh);
 
     // ── Proprietà configurabili ───────────────────────────────────────────────
     int     m_particleCount   = 120;
@@ -152,6 +342,7 @@ private:
     QColor  m_particleColor2  = QColor("#ff7200");
     double  m_particleSize     = 4.0;
     double  m_particleSizeRandom = 8.0;
+    int     m_emissionBudget  = 0;
 
     float   m_rotationSpeed   = 5.0f;
     bool    m_clockwise       = true;
@@ -166,11 +357,54 @@ private:
     QColor  m_minuteHandColor = QColor("#88ccff");
     QColor  m_secondHandColor = QColor("#ffaa88");
 
-    QPointF m_mousePos;
+    int     m_simulationSeed  = 0;     // 0 = casuale
+    double  m_fixedTimeStep   = 0.0;   // 0 = tempo reale
+    QString m_recordPath;
+    QString m_tracePath;               // non vuoto = traccia acquisita
+
+    bool    m_trailEnabled    = false;
+    bool    m_softwareRendering = false;
+    double  m_trailDecay      = 0.9;
+    double  m_trailResolution = 0.5;
+
+    bool    m_lodEnabled      = true;
+    int     m_lodFullSize     = 300;
+    int     m_lodMinSize      = 64;
+
+    int     m_obstacleShapes  = ObstacleTao;
+    QString m_obstacleMask;
+
+    bool    m_flowEnabled     = false;
+    double  m_flowStrength    = 0.4;
+    double  m_flowScale       = 0.35;
+    double  m_flowSwirl       = 0.5;
+
+    QPointF m_mousePos { -1000.0, -1000.0 };
+
+    QString m_sharedGroup;
+    QRectF  m_viewport;
+
+    // ── Input nativo ──────────────────────────────────────────────────────────
+    // Gli eventi aggiornano solo questi campi (nessun segnale, nessun JS):
+    // updateSimulation ne prende un campione per step.
+    static constexpr int MAX_TOUCH_POINTS = SimulationParams::MAX_ATTRACTORS;
+    QPointF m_hoverPos;
+    bool    m_hoverActive = false;
+    QPointF m_touchPoints[MAX_TOUCH_POINTS];
+    int     m_touchCount  = 0;
 
     // ── Stato simulazione ─────────────────────────────────────────────────────
-    std::vector<ParticleData>   m_particles;
-    std::vector<ParticleVertex> m_verticesRender;
+    // Kernel: toccato solo dal worker (o dal render thread a worker fermo)
+    ParticleSystem              m_system { MAX_PARTICLES };
+    std::vector<ParticleVertex> m_verticesRender = std::vector<ParticleVertex>(MAX_PARTICLES);
+
+    quint32            m_activeSeed   = 0;
+    bool               m_resetPending  = false;
+    bool               m_recorderDirty = false;
+    SimulationRecorder m_recorder;
+
+    std::atomic<int> m_burstPending { 0 };
+    QPointF          m_burstPos;
 
     float         m_rotation = 0.0f;
     QElapsedTimer m_timeTracker;
@@ -178,17 +412,87 @@ private:
     float         m_lastDt    = 0.016f;
 
     // ── Stato render ──────────────────────────────────────────────────────────
-    // Separazione netta: m_pendingActiveCount scritto dal worker thread,
-    // m_renderActiveCount letto solo dal render thread (copiato in finished()).
-    std::atomic<int>  m_pendingActiveCount { 0 };
+    // m_renderActiveCount è copiato dal job sul GUI thread (stepFinished) e
+    // letto solo dal render thread durante il sync.
     int               m_renderActiveCount  = 0;
+    int               m_geometryVisible    = 0;
+    QRectF            m_layoutScene;               // ultima traslazione di m_systemNode
 
     QColor m_lastGlowColor1;
     QColor m_lastGlowColor2;
-    qreal  m_lastDpr = 0.0;
+    // Dimensioni (pixel fisici) delle texture richieste al worker
+    int    m_taoTexPx  = 0;
+    int    m_glowTexPx = 0;
+    // Scritto in updateSimulation() (sync), letto sul GUI thread a step
+    // concluso. Il timer è periodico: avviato solo quando l'intervallo cambia,
+    // così il frame a regime non registra timer nell'event dispatcher.
+    int    m_lodFrameInterval = 0;
+    QTimer m_lodTimer;
+    bool   m_frameDue = false;
+
+    // ── Texture asincrone ─────────────────────────────────────────────────────
+    // Il primo frame usa segnaposto; la versione a piena risoluzione arriva
+    // dal worker e viene caricata al primo updatePaintNode successivo.
+    QFutureWatcher<TaoTextureSet> m_textureWatcher;
+    bool m_textureJobPending = false;
+    bool m_texturesReady     = false;
+
+    // ── Maschera ostacoli asincrona ───────────────────────────────────────────
+    // Decodifica + trasformata di distanza sul pool QtConcurrent; il risultato
+    // viene consegnato al kernel in updateSimulation, a worker fermo.
+    QFutureWatcher<ObstacleMaskData> m_maskWatcher;
+    bool    m_maskJobPending = false;
+    bool    m_maskReady      = false;
+    bool    m_maskApplied    = false;
+    QString m_maskRequestPath;            // ultima richiesta (path + griglia)
+    int     m_maskRequestW = 0;
+    int     m_maskRequestH = 0;
+
+    // Lancette (rad, riferimento item): calcolate in updatePaintNode
+    float   m_handAngle[3] = { 0.0f, 0.0f, 0.0f };
+
+    // ── Metriche avvio ────────────────────────────────────────────────────────
+    std::atomic<double> m_firstFrameTime  { -1.0 };
+    std::atomic<double> m_fullQualityTime { -1.0 };
+
+    // ── Tempi per frame ───────────────────────────────────────────────────────
+    // Accumulati sul render thread durante il sync (GUI thread bloccato),
+    // pubblicati negli atomici ogni TIMING_WINDOW_MS.
+    static constexpr int TIMING_WINDOW_MS = 500;
+    enum class GpuTiming { Off, Pending, Ok, Inactive, Unsupported };
+
+    bool    m_timingEnabled     = false;   // GUI thread
+    bool    m_timingActive      = false;   // copia presa nel sync
+    bool    m_stepTimed         = false;   // step privato accodato, durata da leggere
+    qint64  m_timingWindowStart = 0;
+    double  m_syncSum = 0.0, m_stepSum = 0.0, m_gpuSum = 0.0;
+    int     m_syncSamples = 0, m_stepSamples = 0, m_gpuSamples = 0, m_gpuFrames = 0;
+    bool    m_gpuUnsupported    = false;
+
+    std::atomic<double> m_gpuFrameTime { -1.0 };
+    std::atomic<double> m_cpuSyncTime  { -1.0 };
+    std::atomic<double> m_cpuStepTime  { -1.0 };
+    std::atomic<int>    m_gpuTimingStatus { static_cast<int>(GpuTiming::Off) };
+
+    // ── Simulazione condivisa ─────────────────────────────────────────────────
+    // m_shared cambia solo sul GUI thread; il render thread lo usa nel sync.
+    // Lo stato "attivo" lato render serve a svuotare il buffer al cambio modo.
+    std::shared_ptr<SharedSimulation> m_shared;
+    bool    m_sharedActive     = false;
+    bool    m_sharedSubmitted  = false;   // ultimo step condiviso accodato da qui
+    quint64 m_sharedGeneration = 0;
 
     // ── Async ─────────────────────────────────────────────────────────────────
-    QFutureWatcher<void> m_watcher;
+    // Job persistente sul worker condiviso: a fine step scrive su un eventfd,
+    // il QSocketNotifier lo consegna al GUI thread senza eventi allocati.
+    struct StepJob : SimulationJob {
+        using SimulationJob::SimulationJob;
+        int notifyFd = -1;
+    protected:
+        void finished() override;
+    };
+    StepJob          m_stepJob { m_system, m_verticesRender.data() };
+    QSocketNotifier *m_stepNotifier = nullptr;
     // Atomic: garantisce visibilità cross-thread senza mutex, overhead ~zero.
     std::atomic<bool> m_simulationPending { false };
 
@@ -197,9 +501,19 @@ private:
     QSGTransformNode    *m_systemNode   = nullptr;
     QSGTransformNode    *m_taoRotNode   = nullptr;
     QSGNode             *m_clockGroup   = nullptr;
-    QSGSimpleTextureNode *m_glowNode1   = nullptr;
-    QSGSimpleTextureNode *m_glowNode2   = nullptr;
-    QSGSimpleTextureNode *m_taoNode     = nullptr;
+    QSGImageNode        *m_glowNode1    = nullptr;
+    QSGImageNode        *m_glowNode2    = nullptr;
+    QSGImageNode        *m_taoNode      = nullptr;
+    TrailNode           *m_trailNode    = nullptr;
+    // Solo in modalità software: image node con texture persistente (QRhi)
+    // oppure disegno diretto con QPainter (scene graph software)
+    QSGNode             *m_rasterNode    = nullptr;
+    RasterTexture       *m_rasterTexture = nullptr;   // posseduta dall'image node
+    RasterPaintNode     *m_rasterPaint   = nullptr;
+
+    // ── Raster su CPU (render thread) ─────────────────────────────────────────
+    SoftwareRaster m_raster;
+    bool           m_softwareActive = false;
 };
 
 #endif // TAONEW_H
\ No newline at end of file
@@ -0,0 +1,283 @@
+#include "TaoReplay.h"
+
+#include <cmath>
+#include <cstdio>
+
+// 9 cifre significative: round-trip esatto di qualsiasi float
+static QByteArray num(float v)
+{
+    char buf[32];
+    std::snprintf(buf, sizeof(buf), "%.9g", static_cast<double>(v));
+    return QByteArray(buf);
+}
+
+static bool sameLook(const SimulationParams &a, const SimulationParams &b)
+{
+    for (int c = 0; c < 3; ++c)
+        if (a.color1[c] != b.color1[c] || a.color2[c] != b.color2[c])
+            return false;
+    return a.size == b.size && a.sizeRandom == b.sizeRandom && a.spriteScale == b.spriteScale;
+}
+
+static bool sameObstacles(const SimulationParams &a, const SimulationParams &b)
+{
+    return a.obstacleFlags == b.obstacleFlags && a.taoRotation == b.taoRotation
+        && a.handAngle[0] == b.handAngle[0] && a.handAngle[1] == b.handAngle[1]
+        && a.handAngle[2] == b.handAngle[2];
+}
+
+static bool sameFlow(const SimulationParams &a, const SimulationParams &b)
+{
+    return a.flowStrength == b.flowStrength && a.flowScale == b.flowScale
+        && a.flowSwirl == b.flowSwirl;
+}
+
+// ═════════════════════════════════════════════════════════════════════════════
+// SimulationRecorder
+// ═════════════════════════════════════════════════════════════════════════════
+
+bool SimulationRecorder::open(const QString &path, quint64 seed)
+{
+    close();
+    m_file.setFileName(path);
+    if (!m_file.open(QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Text))
+        return false;
+
+    m_file.write("# tao-replay 4\n");
+    m_file.write("seed " + QByteArray::number(seed) + '\n');
+    m_hasLast = false;
+    return true;
+}
+
+void SimulationRecorder::close()
+{
+    if (m_file.isOpen())
+        m_file.close();
+    m_hasLast = false;
+}
+
+void SimulationRecorder::record(const SimulationParams &p)
+{
+    if (!m_file.isOpen())
+        return;
+
+    if (!m_hasLast || !sameLook(p, m_last)) {
+        QByteArray line = "P";
+        for (int c = 0; c < 3; ++c) line += ' ' + QByteArray::number(p.color1[c]);
+        for (int c = 0; c < 3; ++c) line += ' ' + QByteArray::number(p.color2[c]);
+        line += ' ' + num(p.size) + ' ' + num(p.sizeRandom) + ' ' + num(p.spriteScale) + '\n';
+        m_file.write(line);
+    }
+
+    if (!m_hasLast || !sameObstacles(p, m_last)) {
+        QByteArray line = "O " + QByteArray::number(p.obstacleFlags) + ' ' + num(p.taoRotation);
+        for (int k = 0; k < 3; ++k) line += ' ' + num(p.handAngle[k]);
+        m_file.write(line + '\n');
+    }
+
+    if (!m_hasLast || !sameFlow(p, m_last))
+        m_file.write("W " + num(p.flowStrength) + ' ' + num(p.flowScale) + ' '
+                     + num(p.flowSwirl) + '\n');
+
+    const int n = qBound(0, p.attractorCount, SimulationParams::MAX_ATTRACTORS);
+    QByteArray line = "F";
+    line += ' ' + num(p.w) + ' ' + num(p.h) + ' ' + num(p.dt);
+    line += ' ' + QByteArray::number(p.count) + ' ' + QByteArray::number(p.budget);
+    line += ' ' + QByteArray::number(p.burstCount) + ' ' + num(p.burstX) + ' ' + num(p.burstY);
+    line += ' ' + QByteArray::number(n);
+    for (int a = 0; a < n; ++a)
+        line += ' ' + num(p.attractorX[a]) + ' ' + num(p.attractorY[a]);
+    m_file.write(line + '\n');
+
+    m_last    = p;
+    m_hasLast = true;
+}
+
+// ═════════════════════════════════════════════════════════════════════════════
+// Replay
+// ═════════════════════════════════════════════════════════════════════════════
+
+bool loadRecording(const QString &path, SimulationRecording *out, QString *error)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+        if (error) *error = QStringLiteral("cannot open %1").arg(path);
+        return false;
+    }
+
+    out->seed = 0;
+    out->frames.clear();
+
+    SimulationParams look;
+    int lineNo  = 0;
+    int version = 0;
+
+    while (!file.atEnd()) {
+        const QByteArray line = file.readLine().trimmed();
+        ++lineNo;
+        if (line.isEmpty())
+            continue;
+        if (line.startsWith('#')) {
+            if (line == "# tao-replay 1") version = 1;
+            if (line == "# tao-replay 2") version = 2;
+            if (line == "# tao-replay 3") version = 3;
+            if (line == "# tao-replay 4") version = 4;
+            continue;
+        }
+
+        const QList<QByteArray> f = line.split(' ');
+        bool ok = true;
+
+        if (f[0] == "seed" && f.size() == 2) {
+            out->seed = f[1].toULongLong(&ok);
+        } else if (f[0] == "P" && f.size() == 10) {
+            for (int c = 0; c < 3 && ok; ++c) look.color1[c] = static_cast<quint8>(f[1 + c].toUInt(&ok));
+            for (int c = 0; c < 3 && ok; ++c) look.color2[c] = static_cast<quint8>(f[4 + c].toUInt(&ok));
+            if (ok) look.size        = f[7].toFloat(&ok);
+            if (ok) look.sizeRandom  = f[8].toFloat(&ok);
+            if (ok) look.spriteScale = f[9].toFloat(&ok);
+        } else if (f[0] == "O" && version >= 3 && f.size() == 6) {
+            look.obstacleFlags = f[1].toUInt(&ok);
+            if (ok) look.taoRotation = f[2].toFloat(&ok);
+            for (int k = 0; k < 3 && ok; ++k) look.handAngle[k] = f[3 + k].toFloat(&ok);
+        } else if (f[0] == "W" && version >= 4 && f.size() == 4) {
+            look.flowStrength = f[1].toFloat(&ok);
+            if (ok) look.flowScale = f[2].toFloat(&ok);
+            if (ok) look.flowSwirl = f[3].toFloat(&ok);
+        } else if (f[0] == "F" && version == 1 && f.size() == 12) {
+            SimulationParams p = look;
+            bool k[11];
+            p.w          = f[1].toFloat(&k[0]);
+            p.h          = f[2].toFloat(&k[1]);
+            p.attractorX[0] = f[3].toFloat(&k[2]);
+            p.attractorY[0] = f[4].toFloat(&k[3]);
+            p.attractorCount = f[5].toInt(&k[4]) != 0 ? 1 : 0;
+            p.dt         = f[6].toFloat(&k[5]);
+            p.count      = f[7].toInt(&k[6]);
+            p.budget     = f[8].toInt(&k[7]);
+            p.burstCount = f[9].toInt(&k[8]);
+            p.burstX     = f[10].toFloat(&k[9]);
+            p.burstY     = f[11].toFloat(&k[10]);
+            for (bool b : k) ok = ok && b;
+            if (ok) out->frames.push_back(p);
+        } else if (f[0] == "F" && version >= 2 && f.size() >= 10) {
+            SimulationParams p = look;
+            bool k[9];
+            p.w          = f[1].toFloat(&k[0]);
+            p.h          = f[2].toFloat(&k[1]);
+            p.dt         = f[3].toFloat(&k[2]);
+            p.count      = f[4].toInt(&k[3]);
+            p.budget     = f[5].toInt(&k[4]);
+            p.burstCount = f[6].toInt(&k[5]);
+            p.burstX     = f[7].toFloat(&k[6]);
+            p.burstY     = f[8].toFloat(&k[7]);
+            p.attractorCount = f[9].toInt(&k[8]);
+            for (bool b : k) ok = ok && b;
+            ok = ok && p.attractorCount >= 0 && p.attractorCount <= SimulationParams::MAX_ATTRACTORS
+                    && f.size() == 10 + 2 * p.attractorCount;
+            for (int a = 0; ok && a < p.attractorCount; ++a) {
+                p.attractorX[a] = f[10 + 2 * a].toFloat(&ok);
+                if (ok) p.attractorY[a] = f[11 + 2 * a].toFloat(&ok);
+            }
+            if (ok) out->frames.push_back(p);
+        } else {
+            ok = false;
+        }
+
+        if (!ok) {
+            if (error) *error = QStringLiteral("%1:%2: malformed record").arg(path).arg(lineNo);
+            return false;
+        }
+    }
+
+    if (version == 0) {
+        if (error) *error = QStringLiteral("%1: missing '# tao-replay' header").arg(path);
+        return false;
+    }
+    return true;
+}
+
+// ═════════════════════════════════════════════════════════════════════════════
+// Stato di riferimento
+// ═════════════════════════════════════════════════════════════════════════════
+
+bool writeState(const QString &path, const ParticleSystem &system)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Text))
+        return false;
+
+    file.write("# tao-state 1\n");
+    file.write("live " + QByteArray::number(system.liveCount()) + '\n');
+
+    const ParticleData *p = system.particles();
+    for (int i = 0; i < system.liveCount(); ++i) {
+        const ParticleData &d = p[i];
+        file.write(num(d.x) + ' ' + num(d.y) + ' ' + num(d.vx) + ' ' + num(d.vy) + ' '
+                   + num(d.life) + ' ' + num(d.decay) + ' ' + num(d.size) + ' '
+                   + QByteArray::number(d.variant) + '\n');
+    }
+    return true;
+}
+
+bool compareState(const QString &path, const ParticleSystem &system,
+                  float tolerance, QString *report)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+        if (report) *report = QStringLiteral("cannot open %1").arg(path);
+        return false;
+    }
+
+    static const char *const names[] = { "x", "y", "vx", "vy", "life", "decay", "size" };
+    const ParticleData *p = system.particles();
+    int index = -1;   // -1 finché non si è letta la riga "live"
+
+    while (!file.atEnd()) {
+        const QByteArray line = file.readLine().trimmed();
+        if (line.isEmpty() || line.startsWith('#'))
+            continue;
+
+        const QList<QByteArray> f = line.split(' ');
+        if (index < 0) {
+            const int live = (f.size() == 2 && f[0] == "live") ? f[1].toInt() : -1;
+            if (live != system.liveCount()) {
+                if (report) *report = QStringLiteral("live count: expected %1, got %2")
+                                          .arg(live).arg(system.liveCount());
+                return false;
+            }
+            index = 0;
+            continue;
+        }
+
+        if (f.size() != 8 || index >= system.liveCount()) {
+            if (report) *report = QStringLiteral("malformed particle record %1").arg(index);
+            return false;
+        }
+
+        const ParticleData &d = p[index];
+        const float actual[] = { d.x, d.y, d.vx, d.vy, d.life, d.decay, d.size };
+        for (int k = 0; k < 7; ++k) {
+            const float expected = f[k].toFloat();
+            if (!(std::fabs(expected - actual[k]) <= tolerance)) {
+                if (report) *report = QStringLiteral("particle %1 %2: expected %3, got %4")
+                                          .arg(index).arg(QLatin1String(names[k]))
+                                          .arg(double(expected), 0, 'g', 9)
+                                          .arg(double(actual[k]), 0, 'g', 9);
+                return false;
+            }
+        }
+        if (f[7].toUInt() != d.variant) {
+            if (report) *report = QStringLiteral("particle %1 variant: expected %2, got %3")
+                                      .arg(index).arg(QString::fromLatin1(f[7])).arg(d.variant);
+            return false;
+        }
+        ++index;
+    }
+
+    if (index != system.liveCount()) {
+        if (report) *report = QStringLiteral("state truncated after %1 particles").arg(qMax(0, index));
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,65 @@
+#ifndef TAOREPLAY_H
+#define TAOREPLAY_H
+
+#include "ParticleSystem.h"
+
+#include <QFile>
+#include <QString>
+#include <vector>
+
+// ── Formato di registrazione ──────────────────────────────────────────────────
+// Testo, una riga per record, float con 9 cifre significative (round-trip
+// esatto di un float):
+//
+//   # tao-replay 4
+//   seed <n>
+//   P <c1r> <c1g> <c1b> <c2r> <c2g> <c2b> <size> <sizeRandom> <spriteScale>
+//   O <flags> <rotation> <hour> <minute> <second>
+//   W <flowStrength> <flowScale> <flowSwirl>
+//   F <w> <h> <dt> <count> <budget> <burst> <bx> <by> <n> [<x> <y>]×n
+//
+// Le righe P, O e W compaiono solo quando aspetto, ostacoli o flusso cambiano;
+// ogni F è uno step con i suoi n attrattori. La maschera ostacoli (immagine)
+// non è registrata. Restano leggibili le versioni 3 (senza W: flusso spento),
+// 2 (senza O: solo il disco del Tao) e 1 (un solo mouse:
+// F <w> <h> <mx> <my> <valid> <dt> ...).
+
+struct SimulationRecording {
+    quint64                       seed = 0;
+    std::vector<SimulationParams> frames;
+};
+
+// ── SimulationRecorder ────────────────────────────────────────────────────────
+
+class SimulationRecorder
+{
+public:
+    ~SimulationRecorder() { close(); }
+
+    bool open(const QString &path, quint64 seed);
+    void close();
+    bool isOpen() const { return m_file.isOpen(); }
+
+    // Un frame: da chiamare con gli stessi parametri passati a step()
+    void record(const SimulationParams &params);
+
+private:
+    QFile            m_file;
+    SimulationParams m_last;
+    bool             m_hasLast = false;
+};
+
+// ── Replay e confronto con lo stato di riferimento ────────────────────────────
+
+bool loadRecording(const QString &path, SimulationRecording *out, QString *error);
+
+// Stato del pool (solo il prefisso vivo), stesso formato testuale
+bool writeState(const QString &path, const ParticleSystem &system);
+
+// Confronta il pool con uno stato salvato da writeState(). `tolerance` è
+// l'errore assoluto ammesso su ogni campo float; in caso di differenza
+// `report` descrive la prima particella divergente.
+bool compareState(const QString &path, const ParticleSystem &system,
+                  float tolerance, QString *report);
+
+#endif // TAOREPLAY_H
@@ -0,0 +1,299 @@
+#include "TaoTrace.h"
+
+#include <QCoreApplication>
+#include <QFile>
+#include <QLoggingCategory>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+// Categoria di log del plugin: definita qui perché TaoTrace è compilato anche
+// in tao-replay, dove TaoNew non c'è
+Q_LOGGING_CATEGORY(lcTao, "tao.native")
+
+// ═════════════════════════════════════════════════════════════════════════════
+// Stato (condiviso da tutti i thread)
+// ═════════════════════════════════════════════════════════════════════════════
+
+std::atomic<bool> TaoTrace::s_enabled { false };
+
+namespace {
+
+// Slot del ring buffer. `seq` = indice globale + 1 a scrittura completa, 0
+// durante la scrittura: la lettura scarta gli slot a metà o sovrascritti.
+struct TraceEvent {
+    std::atomic<quint64> seq { 0 };
+    const char *name  = nullptr;
+    qint64      ts    = 0;       // ns, orologio monotono
+    qint64      value = 0;       // durata (X) o valore (C)
+    int         tid   = 0;
+    char        phase = 0;       // 'X', 'C', 'i'
+};
+
+struct ThreadName {
+    int         tid  = 0;
+    const char *name = nullptr;
+};
+
+constexpr int MAX_THREAD_NAMES = 32;
+
+// Scrittura periodica del file mentre la traccia è attiva: un crash o un kill
+// perdono al più gli ultimi FLUSH_INTERVAL_MS
+constexpr int FLUSH_INTERVAL_MS = 5000;
+
+std::unique_ptr<TraceEvent[]> s_events;
+std::atomic<quint64>          s_head { 0 };
+
+// GUI thread (acquire/release) e nameThread, mai nel percorso degli eventi
+std::mutex  s_stateMutex;
+QString     s_path;
+int         s_users  = 0;
+qint64      s_origin = 0;
+ThreadName  s_threads[MAX_THREAD_NAMES];
+int         s_threadCount = 0;
+quint64     s_flushedHead = 0;   // s_head all'ultima scrittura
+bool        s_quitHooked  = false;
+
+// Thread di scrittura periodica, avviato e fermato dal GUI thread. Sullo
+// heap e fermato anche ad aboutToQuit: un std::thread statico ancora attivo
+// alla distruzione dei globali chiamerebbe std::terminate().
+struct Flusher {
+    std::thread             thread;
+    std::mutex              mutex;
+    std::condition_variable wake;
+    bool                    quit = false;
+};
+Flusher    *s_flusher = nullptr;
+
+int currentTid()
+{
+    thread_local const int tid = static_cast<int>(::syscall(SYS_gettid));
+    return tid;
+}
+
+void record(char phase, const char *name, qint64 ts, qint64 value)
+{
+    const quint64 i = s_head.fetch_add(1, std::memory_order_relaxed);
+    TraceEvent &e = s_events[i & (TaoTrace::CAPACITY - 1)];
+    e.seq.store(0, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    e.name  = name;
+    e.ts    = ts;
+    e.value = value;
+    e.tid   = currentTid();
+    e.phase = phase;
+    e.seq.store(i + 1, std::memory_order_release);
+}
+
+bool writeTrace(const QString &path, qint64 origin)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+        return false;
+
+    const int pid = static_cast<int>(::getpid());
+    char line[256];
+    bool first = true;
+    const auto put = [&](int n) {
+        if (n <= 0) return;
+        if (!first) file.write(",\n", 2);
+        first = false;
+        file.write(line, qMin(n, static_cast<int>(sizeof(line)) - 1));
+    };
+
+    file.write("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+    for (int t = 0; t < s_threadCount; ++t)
+        put(std::snprintf(line, sizeof(line),
+                          "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":%d,\"tid\":%d,\"args\":{\"name\":\"%s\"}}",
+                          pid, s_threads[t].tid, s_threads[t].name));
+
+    const quint64 head  = s_head.load(std::memory_order_acquire);
+    const quint64 begin = head > quint64(TaoTrace::CAPACITY) ? head - TaoTrace::CAPACITY : 0;
+    for (quint64 i = begin; i < head; ++i) {
+        const TraceEvent &e = s_events[i & (TaoTrace::CAPACITY - 1)];
+        if (e.seq.load(std::memory_order_acquire) != i + 1)
+            continue;
+        const char  *name  = e.name;
+        const qint64 ts    = e.ts;
+        const qint64 value = e.value;
+        const int    tid   = e.tid;
+        const char   phase = e.phase;
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (e.seq.load(std::memory_order_relaxed) != i + 1 || ts < origin)
+            continue;
+
+        const double us = static_cast<double>(ts - origin) / 1000.0;
+        switch (phase) {
+        case 'X':
+            put(std::snprintf(line, sizeof(line),
+                              "{\"name\":\"%s\",\"cat\":\"tao\",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,\"pid\":%d,\"tid\":%d}",
+                              name, us, static_cast<double>(value) / 1000.0, pid, tid));
+            break;
+        case 'C':
+            put(std::snprintf(line, sizeof(line),
+                              "{\"name\":\"%s\",\"cat\":\"tao\",\"ph\":\"C\",\"ts\":%.3f,\"pid\":%d,\"tid\":%d,\"args\":{\"value\":%lld}}",
+                              name, us, pid, tid, static_cast<long long>(value)));
+            break;
+        case 'i':
+            put(std::snprintf(line, sizeof(line),
+                              "{\"name\":\"%s\",\"cat\":\"tao\",\"ph\":\"i\",\"s\":\"t\",\"ts\":%.3f,\"pid\":%d,\"tid\":%d}",
+                              name, us, pid, tid));
+            break;
+        }
+    }
+    file.write("\n]}\n");
+    return file.error() == QFileDevice::NoError;
+}
+
+// Sotto s_stateMutex
+void writeLocked()
+{
+    s_flushedHead = s_head.load(std::memory_order_acquire);
+    if (!writeTrace(s_path, s_origin))
+        qCWarning(lcTao) << "cannot write trace" << s_path;
+}
+
+void flushLoop(Flusher *f)
+{
+    std::unique_lock<std::mutex> lock(f->mutex);
+    while (!f->wake.wait_for(lock, std::chrono::milliseconds(FLUSH_INTERVAL_MS),
+                             [f] { return f->quit; })) {
+        lock.unlock();
+        TaoTrace::flush();
+        lock.lock();
+    }
+}
+
+// Fuori da s_stateMutex: il thread può essere dentro flush()
+void stopFlusher(Flusher *f)
+{
+    if (!f)
+        return;
+    {
+        std::lock_guard<std::mutex> lock(f->mutex);
+        f->quit = true;
+    }
+    f->wake.notify_one();
+    f->thread.join();
+    delete f;
+}
+
+Flusher *takeFlusher()
+{
+    std::lock_guard<std::mutex> lock(s_stateMutex);
+    return std::exchange(s_flusher, nullptr);
+}
+
+// Uscita ordinata: nessuno chiamerà release() prima della fine del processo
+void finishOnQuit()
+{
+    stopFlusher(takeFlusher());
+    TaoTrace::flush();
+}
+
+} // namespace
+
+// ═════════════════════════════════════════════════════════════════════════════
+// Avvio / stop (GUI thread)
+// ═════════════════════════════════════════════════════════════════════════════
+
+void TaoTrace::acquire(const QString &path)
+{
+    std::lock_guard<std::mutex> lock(s_stateMutex);
+    s_path = path;
+    if (s_users++ > 0)
+        return;
+
+    // Il buffer non viene mai liberato: un evento iniziato appena prima di uno
+    // stop può ancora scriverci
+    if (!s_events)
+        s_events.reset(new TraceEvent[CAPACITY]);
+    s_head.store(0, std::memory_order_relaxed);
+    for (int i = 0; i < CAPACITY; ++i)
+        s_events[i].seq.store(0, std::memory_order_relaxed);
+    s_origin = now();
+    s_flushedHead = 0;
+    s_enabled.store(true, std::memory_order_release);
+
+    // Il file si aggiorna anche a traccia aperta: periodicamente e all'uscita
+    // ordinata dell'applicazione
+    s_flusher = new Flusher;
+    s_flusher->thread = std::thread(flushLoop, s_flusher);
+    if (!s_quitHooked) {
+        if (QCoreApplication *app = QCoreApplication::instance()) {
+            QObject::connect(app, &QCoreApplication::aboutToQuit, app, finishOnQuit);
+            s_quitHooked = true;
+        }
+    }
+}
+
+void TaoTrace::release()
+{
+    // acquire/release solo dal GUI thread: s_users non cambia tra i due lock
+    Flusher *flusher = nullptr;
+    {
+        std::lock_guard<std::mutex> lock(s_stateMutex);
+        if (s_users == 0 || --s_users > 0)
+            return;
+        s_enabled.store(false, std::memory_order_release);
+        flusher = std::exchange(s_flusher, nullptr);
+    }
+    stopFlusher(flusher);
+
+    std::lock_guard<std::mutex> lock(s_stateMutex);
+    writeLocked();
+}
+
+void TaoTrace::flush()
+{
+    std::lock_guard<std::mutex> lock(s_stateMutex);
+    if (s_users == 0 || s_head.load(std::memory_order_acquire) == s_flushedHead)
+        return;
+    writeLocked();
+}
+
+void TaoTrace::nameThread(const char *name)
+{
+    thread_local bool named = false;
+    if (named || !isEnabled())
+        return;
+    named = true;
+
+    std::lock_guard<std::mutex> lock(s_stateMutex);
+    if (s_threadCount < MAX_THREAD_NAMES)
+        s_threads[s_threadCount++] = { currentTid(), name };
+}
+
+// ═════════════════════════════════════════════════════════════════════════════
+// Eventi (qualsiasi thread)
+// ═════════════════════════════════════════════════════════════════════════════
+
+qint64 TaoTrace::now()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void TaoTrace::complete(const char *name, qint64 startNs, qint64 endNs)
+{
+    if (isEnabled())
+        record('X', name, startNs, endNs - startNs);
+}
+
+void TaoTrace::counter(const char *name, qint64 value)
+{
+    if (isEnabled())
+        record('C', name, now(), value);
+}
+
+void TaoTrace::instant(const char *name)
+{
+    if (isEnabled())
+        record('i', name, now(), 0);
+}
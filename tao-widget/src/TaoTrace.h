@@ -0,0 +1,69 @@
+#ifndef TAOTRACE_H
+#define TAOTRACE_H
+
+#include <QLoggingCategory>
+#include <QString>
+#include <QtGlobal>
+#include <atomic>
+
+Q_DECLARE_LOGGING_CATEGORY(lcTao)
+
+// ── TaoTrace ──────────────────────────────────────────────────────────────────
+// Traccia temporale opzionale, unica per processo, esportata nel formato JSON
+// di Chrome (caricabile in Perfetto / chrome://tracing). Gli eventi finiscono
+// in un ring buffer fisso di CAPACITY eventi, allocato al primo avvio: a regime
+// ogni evento costa una fetch_add e le letture dell'orologio, senza lock né
+// allocazioni; a traccia spenta resta un load atomico. Il file, con gli ultimi
+// CAPACITY eventi, viene scritto quando l'ultimo utente rilascia la traccia,
+// all'uscita dell'applicazione e ogni pochi secondi da un thread dedicato,
+// così anche un crash o un kill lasciano una traccia quasi completa.
+//
+// I nomi di eventi e thread devono essere stringhe statiche: nel buffer resta
+// solo il puntatore.
+
+class TaoTrace
+{
+public:
+    static constexpr int CAPACITY = 1 << 16;   // potenza di 2, ~2.5 MB
+
+    static bool isEnabled() { return s_enabled.load(std::memory_order_acquire); }
+
+    // GUI thread. Più utenti possono tenere aperta la stessa traccia: il file
+    // (l'ultimo percorso richiesto) viene scritto all'ultimo release().
+    static void acquire(const QString &path);
+    static void release();
+
+    // Riscrive subito il file con gli eventi attuali, a traccia ancora
+    // attiva (qualsiasi thread; nulla se non ci sono eventi nuovi)
+    static void flush();
+
+    // Nome del thread chiamante nella traccia (registrato una volta)
+    static void nameThread(const char *name);
+
+    static qint64 now();
+    static void   complete(const char *name, qint64 startNs, qint64 endNs);
+    static void   counter(const char *name, qint64 value);
+    static void   instant(const char *name);
+
+private:
+    static std::atomic<bool> s_enabled;
+};
+
+// Span con inizio e fine nello scope corrente (evento "X")
+class TraceSpan
+{
+public:
+    explicit TraceSpan(const char *name)
+        : m_name(TaoTrace::isEnabled() ? name : nullptr)
+        , m_start(m_name ? TaoTrace::now() : 0) {}
+    ~TraceSpan() { if (m_name) TaoTrace::complete(m_name, m_start, TaoTrace::now()); }
+
+    TraceSpan(const TraceSpan &) = delete;
+    TraceSpan &operator=(const TraceSpan &) = delete;
+
+private:
+    const char *m_name;
+    qint64      m_start;
+};
+
+#endif // TAOTRACE_H
@@ -0,0 +1,441 @@
+#include "TrailNode.h"
+
+#include <QFile>
+#include <QQuickWindow>
+#include <QtMath>
+#include <cstring>
+
+// ═════════════════════════════════════════════════════════════════════════════
+// Helpers interni (file-scope)
+// ═════════════════════════════════════════════════════════════════════════════
+
+static QShader loadShader(const QString &name)
+{
+    QFile f(name);
+    if (f.open(QIODevice::ReadOnly))
+        return QShader::fromSerialized(f.readAll());
+    return {};
+}
+
+// Blocco uniform comune (std140): mat4 + due float, arrotondato a 16 byte.
+struct TrailUniforms {
+    float mvp[16];
+    float a;        // factor / qt_Opacity
+    float b;        // fade   / sizeScale
+    float pad[2];
+};
+static_assert(sizeof(TrailUniforms) == 80, "layout std140 atteso dagli shader");
+
+static void writeUniforms(QRhiResourceUpdateBatch *u, QRhiBuffer *buf,
+                          const QMatrix4x4 &mvp, float a, float b)
+{
+    TrailUniforms data;
+    std::memcpy(data.mvp, mvp.constData(), sizeof(data.mvp));
+    data.a = a;
+    data.b = b;
+    data.pad[0] = data.pad[1] = 0.0f;
+    u->updateDynamicBuffer(buf, 0, sizeof(data), &data);
+}
+
+static QRhiShaderResourceBindings *createTextureSrb(QRhi *rhi, QRhiBuffer *ubuf,
+                                                    QRhiTexture *tex, QRhiSampler *sampler)
+{
+    QRhiShaderResourceBindings *srb = rhi->newShaderResourceBindings();
+    srb->setBindings({
+        QRhiShaderResourceBinding::uniformBuffer(0,
+            QRhiShaderResourceBinding::VertexStage | QRhiShaderResourceBinding::FragmentStage, ubuf),
+        QRhiShaderResourceBinding::sampledTexture(1,
+            QRhiShaderResourceBinding::FragmentStage, tex, sampler),
+    });
+    srb->create();
+    return srb;
+}
+
+// Quad unitario in triangle strip: solo posizione (xy).
+static QRhiVertexInputLayout quadInputLayout()
+{
+    QRhiVertexInputLayout il;
+    il.setBindings({ { 2 * sizeof(float) } });
+    il.setAttributes({ { 0, 0, QRhiVertexInputAttribute::Float2, 0 } });
+    return il;
+}
+
+// Stesso layout di particleAttributes() in TaoNew.cpp: 16 byte/vertice.
+static QRhiVertexInputLayout particleInputLayout()
+{
+    QRhiVertexInputLayout il;
+    il.setBindings({ { sizeof(ParticleVertex) } });
+    il.setAttributes({
+        { 0, 0, QRhiVertexInputAttribute::Float2,      0 },  // pos
+        { 0, 1, QRhiVertexInputAttribute::Float,       8 },  // size
+        { 0, 2, QRhiVertexInputAttribute::UNormByte4, 12 },  // color
+    });
+    return il;
+}
+
+template <typename T>
+static void releaseResource(T *&res)
+{
+    delete res;
+    res = nullptr;
+}
+
+// ═════════════════════════════════════════════════════════════════════════════
+// TrailNode — costruttore / distruttore
+// ═════════════════════════════════════════════════════════════════════════════
+
+TrailNode::TrailNode(QQuickWindow *window, int capacity)
+    : m_window(window)
+    , m_vertices(static_cast<size_t>(capacity))
+{
+}
+
+TrailNode::~TrailNode()
+{
+    releaseResources();
+}
+
+// ═════════════════════════════════════════════════════════════════════════════
+// Parametri (render thread, durante la sync)
+// ═════════════════════════════════════════════════════════════════════════════
+
+void TrailNode::setItemSize(const QSizeF &size, qreal dpr)
+{
+    m_itemSize = size;
+    m_dpr      = dpr;
+}
+
+void TrailNode::setResolution(float scale)
+{
+    m_resolution = qBound(0.1f, scale, 1.0f);
+}
+
+void TrailNode::setDecay(float decay)
+{
+    m_decay = qBound(0.0f, decay, 0.99f);
+}
+
+// Tempo trascorso dall'ultima sync: si accumula finché un prepare non lo
+// consuma, così un frame ridisegnato senza sync non decade due volte.
+void TrailNode::setFrameTime(float dt)
+{
+    m_frameTime = qBound(0.0f, m_frameTime + dt, 1.0f);
+}
+
+void TrailNode::setParticles(const ParticleVertex *vertices, int count)
+{
+    m_vertexCount = qBound(0, count, static_cast<int>(m_vertices.size()));
+    std::memcpy(m_vertices.data(), vertices,
+                static_cast<size_t>(m_vertexCount) * sizeof(ParticleVertex));
+    m_freshParticles = true;
+}
+
+// ═════════════════════════════════════════════════════════════════════════════
+// Risorse
+// ═════════════════════════════════════════════════════════════════════════════
+
+bool TrailNode::ensureTargets(QRhi *rhi)
+{
+    const QSize size(qMax(1, qCeil(m_itemSize.width()  * m_dpr * m_resolution)),
+                     qMax(1, qCeil(m_itemSize.height() * m_dpr * m_resolution)));
+    if (m_tex[0] && size == m_targetSize)
+        return true;
+
+    releaseTargets();
+
+    // Half-float se disponibile: il decadimento moltiplicativo non si
+    // "incastra" sui valori bassi come accade in 8 bit.
+    const bool halfFloat = rhi->isTextureFormatSupported(QRhiTexture::RGBA16F);
+    const QRhiTexture::Format format = halfFloat ? QRhiTexture::RGBA16F : QRhiTexture::RGBA8;
+    m_fade = halfFloat ? 0.5f / 255.0f : 1.0f / 255.0f;
+
+    for (int i = 0; i < 2; ++i) {
+        m_tex[i] = rhi->newTexture(format, size, 1, QRhiTexture::RenderTarget);
+        if (!m_tex[i]->create())
+            return false;
+        m_rt[i] = rhi->newTextureRenderTarget({ m_tex[i] });
+    }
+    m_rtRp = m_rt[0]->newCompatibleRenderPassDescriptor();
+    for (int i = 0; i < 2; ++i) {
+        m_rt[i]->setRenderPassDescriptor(m_rtRp);
+        if (!m_rt[i]->create())
+            return false;
+    }
+
+    m_targetSize = size;
+    m_current    = 0;
+    m_needsClear = true;
+    return true;
+}
+
+bool TrailNode::ensureOffscreenPipelines(QRhi *rhi)
+{
+    if (m_decayPs && m_particlePs)
+        return true;
+
+    // Ricostruzione completa (anche dopo un tentativo fallito a metà)
+    releaseResource(m_decayPs);
+    releaseResource(m_particlePs);
+    for (int i = 0; i < 2; ++i) {
+        releaseResource(m_decaySrb[i]);
+        releaseResource(m_compositeSrb[i]);
+    }
+
+    if (!m_sampler) {
+        m_sampler = rhi->newSampler(QRhiSampler::Linear, QRhiSampler::Linear, QRhiSampler::None,
+                                    QRhiSampler::ClampToEdge, QRhiSampler::ClampToEdge);
+        m_sampler->create();
+    }
+    if (!m_quadVbuf) {
+        m_quadVbuf = rhi->newBuffer(QRhiBuffer::Immutable, QRhiBuffer::VertexBuffer, 8 * sizeof(float));
+        m_quadVbuf->create();
+        m_quadUploaded = false;
+    }
+    if (!m_particleVbuf) {
+        m_particleVbuf = rhi->newBuffer(QRhiBuffer::Dynamic, QRhiBuffer::VertexBuffer,
+                                        static_cast<quint32>(m_vertices.size() * sizeof(ParticleVertex)));
+        m_particleVbuf->create();
+    }
+    for (QRhiBuffer **ubuf : { &m_decayUbuf, &m_particleUbuf, &m_compositeUbuf }) {
+        if (!*ubuf) {
+            *ubuf = rhi->newBuffer(QRhiBuffer::Dynamic, QRhiBuffer::UniformBuffer, sizeof(TrailUniforms));
+            (*ubuf)->create();
+        }
+    }
+    if (!m_particleSrb) {
+        m_particleSrb = rhi->newShaderResourceBindings();
+        m_particleSrb->setBindings({
+            QRhiShaderResourceBinding::uniformBuffer(0,
+                QRhiShaderResourceBinding::VertexStage | QRhiShaderResourceBinding::FragmentStage, m_particleUbuf),
+        });
+        m_particleSrb->create();
+    }
+    for (int i = 0; i < 2; ++i) {
+        m_decaySrb[i]     = createTextureSrb(rhi, m_decayUbuf,     m_tex[i], m_sampler);
+        m_compositeSrb[i] = createTextureSrb(rhi, m_compositeUbuf, m_tex[i], m_sampler);
+    }
+
+    const QShader trailVs    = loadShader(QStringLiteral(":/taoplugin/shaders/trail.vert.qsb"));
+    const QShader trailFs    = loadShader(QStringLiteral(":/taoplugin/shaders/trail.frag.qsb"));
+    const QShader particleVs = loadShader(QStringLiteral(":/taoplugin/shaders/particle.vert.qsb"));
+    const QShader particleFs = loadShader(QStringLiteral(":/taoplugin/shaders/particle.frag.qsb"));
+    if (!trailVs.isValid() || !trailFs.isValid() || !particleVs.isValid() || !particleFs.isValid())
+        return false;
+
+    // Decadimento: copia attenuata del frame precedente, nessun blending.
+    m_decayPs = rhi->newGraphicsPipeline();
+    m_decayPs->setTopology(QRhiGraphicsPipeline::TriangleStrip);
+    m_decayPs->setShaderStages({ { QRhiShaderStage::Vertex, trailVs },
+                                 { QRhiShaderStage::Fragment, trailFs } });
+    m_decayPs->setVertexInputLayout(quadInputLayout());
+    m_decayPs->setShaderResourceBindings(m_decaySrb[0]);
+    m_decayPs->setRenderPassDescriptor(m_rtRp);
+    if (!m_decayPs->create())
+        return false;
+
+    // Particelle: stesso blending additivo di ParticleMaterialShader.
+    QRhiGraphicsPipeline::TargetBlend additive;
+    additive.enable   = true;
+    additive.srcColor = QRhiGraphicsPipeline::SrcAlpha;
+    additive.dstColor = QRhiGraphicsPipeline::One;
+    additive.srcAlpha = QRhiGraphicsPipeline::One;
+    additive.dstAlpha = QRhiGraphicsPipeline::One;
+
+    m_particlePs = rhi->newGraphicsPipeline();
+    m_particlePs->setTopology(QRhiGraphicsPipeline::Points);
+    m_particlePs->setTargetBlends({ additive });
+    m_particlePs->setShaderStages({ { QRhiShaderStage::Vertex, particleVs },
+                                    { QRhiShaderStage::Fragment, particleFs } });
+    m_particlePs->setVertexInputLayout(particleInputLayout());
+    m_particlePs->setShaderResourceBindings(m_particleSrb);
+    m_particlePs->setRenderPassDescriptor(m_rtRp);
+    return m_particlePs->create();
+}
+
+bool TrailNode::ensureCompositePipeline(QRhi *rhi)
+{
+    QRhiRenderTarget *rt = renderTarget();
+    QRhiRenderPassDescriptor *rp = rt->renderPassDescriptor();
+    if (m_compositePs && rp == m_compositeRp && m_compositePs->sampleCount() == rt->sampleCount())
+        return true;
+
+    releaseResource(m_compositePs);
+    m_compositeRp = rp;
+
+    const QShader vs = loadShader(QStringLiteral(":/taoplugin/shaders/trail.vert.qsb"));
+    const QShader fs = loadShader(QStringLiteral(":/taoplugin/shaders/trail.frag.qsb"));
+    if (!vs.isValid() || !fs.isValid())
+        return false;
+
+    // Composizione premoltiplicata additiva: la scia illumina ciò che sta sotto
+    // come facevano le particelle disegnate direttamente.
+    QRhiGraphicsPipeline::TargetBlend blend;
+    blend.enable   = true;
+    blend.srcColor = QRhiGraphicsPipeline::One;
+    blend.dstColor = QRhiGraphicsPipeline::One;
+    blend.srcAlpha = QRhiGraphicsPipeline::One;
+    blend.dstAlpha = QRhiGraphicsPipeline::OneMinusSrcAlpha;
+
+    m_compositePs = rhi->newGraphicsPipeline();
+    m_compositePs->setTopology(QRhiGraphicsPipeline::TriangleStrip);
+    m_compositePs->setTargetBlends({ blend });
+    m_compositePs->setSampleCount(rt->sampleCount());
+    m_compositePs->setShaderStages({ { QRhiShaderStage::Vertex, vs },
+                                     { QRhiShaderStage::Fragment, fs } });
+    m_compositePs->setVertexInputLayout(quadInputLayout());
+    m_compositePs->setShaderResourceBindings(m_compositeSrb[0]);
+    m_compositePs->setRenderPassDescriptor(rp);
+    return m_compositePs->create();
+}
+
+void TrailNode::releaseTargets()
+{
+    releaseResource(m_compositePs);
+    releaseResource(m_decayPs);
+    releaseResource(m_particlePs);
+    for (int i = 0; i < 2; ++i) {
+        releaseResource(m_decaySrb[i]);
+        releaseResource(m_compositeSrb[i]);
+        releaseResource(m_rt[i]);
+        releaseResource(m_tex[i]);
+    }
+    releaseResource(m_rtRp);
+    m_compositeRp = nullptr;
+    m_targetSize  = QSize();
+}
+
+void TrailNode::releaseResources()
+{
+    releaseTargets();
+    releaseResource(m_particleSrb);
+    releaseResource(m_sampler);
+    releaseResource(m_quadVbuf);
+    releaseResource(m_particleVbuf);
+    releaseResource(m_decayUbuf);
+    releaseResource(m_particleUbuf);
+    releaseResource(m_compositeUbuf);
+    m_quadUploaded = false;
+}
+
+// ═════════════════════════════════════════════════════════════════════════════
+// prepare  (fuori dal render pass principale: qui gira il pass offscreen)
+// ═════════════════════════════════════════════════════════════════════════════
+
+void TrailNode::prepare()
+{
+    QRhi *rhi = m_window ? m_window->rhi() : nullptr;
+    QRhiCommandBuffer *cb = commandBuffer();
+    if (!rhi || !cb || m_itemSize.isEmpty())
+        return;
+    if (!ensureTargets(rhi) || !ensureOffscreenPipelines(rhi) || !ensureCompositePipeline(rhi))
+        return;
+
+    QRhiResourceUpdateBatch *u = rhi->nextResourceUpdateBatch();
+    if (!m_quadUploaded) {
+        static const float quad[] = { 0.0f, 0.0f,  1.0f, 0.0f,  0.0f, 1.0f,  1.0f, 1.0f };
+        u->uploadStaticBuffer(m_quadVbuf, quad);
+        m_quadUploaded = true;
+    }
+
+    // Proiezioni offscreen: la riga v della texture corrisponde sempre a
+    // y = v·h dell'item, qualunque sia l'orientamento del framebuffer.
+    const float w   = static_cast<float>(m_itemSize.width());
+    const float h   = static_cast<float>(m_itemSize.height());
+    const bool  yUp = rhi->isYUpInFramebuffer();
+
+    QMatrix4x4 unitProj = rhi->clipSpaceCorrMatrix();
+    unitProj.ortho(0.0f, 1.0f, yUp ? 0.0f : 1.0f, yUp ? 1.0f : 0.0f, -1.0f, 1.0f);
+    QMatrix4x4 itemProj = rhi->clipSpaceCorrMatrix();
+    itemProj.ortho(0.0f, w, yUp ? 0.0f : h, yUp ? h : 0.0f, -1.0f, 1.0f);
+
+    QMatrix4x4 composite = *projectionMatrix() * *matrix();
+    composite.scale(w, h);
+
+    // decay e fade valgono per 1/60 s: a 144 Hz o a 30 Hz la scia dura uguale
+    const float ticks = m_frameTime * 60.0f;
+    m_frameTime = 0.0f;
+    writeUniforms(u, m_decayUbuf,     unitProj,  qPow(m_decay, ticks), m_fade * ticks);
+    writeUniforms(u, m_particleUbuf,  itemProj,  1.0f,    m_resolution);
+    writeUniforms(u, m_compositeUbuf, composite, static_cast<float>(inheritedOpacity()), 0.0f);
+
+    // Step ancora in corso: nessuna particella nuova, il frame applica solo
+    // il decadimento (ridisegnare le vecchie le sommerebbe sulla scia).
+    const bool drawParticles = m_freshParticles && m_vertexCount > 0;
+    m_freshParticles = false;
+
+    if (drawParticles)
+        u->updateDynamicBuffer(m_particleVbuf, 0,
+                               static_cast<quint32>(m_vertexCount * sizeof(ParticleVertex)),
+                               m_vertices.data());
+
+    const QColor clear(Qt::transparent);
+    const QRhiDepthStencilClearValue ds(1.0f, 0);
+
+    // Texture appena create: contenuto indefinito, va azzerato una volta.
+    if (m_needsClear) {
+        cb->beginPass(m_rt[m_current], clear, ds, u);
+        cb->endPass();
+        u = nullptr;
+        m_needsClear = false;
+    }
+
+    const int src = m_current;
+    const int dst = 1 - m_current;
+    const QRhiViewport viewport(0, 0, m_targetSize.width(), m_targetSize.height());
+
+    cb->beginPass(m_rt[dst], clear, ds, u);
+
+    cb->setGraphicsPipeline(m_decayPs);
+    cb->setViewport(viewport);
+    cb->setShaderResources(m_decaySrb[src]);
+    const QRhiCommandBuffer::VertexInput quadInput(m_quadVbuf, 0);
+    cb->setVertexInput(0, 1, &quadInput);
+    cb->draw(4);
+
+    if (drawParticles) {
+        cb->setGraphicsPipeline(m_particlePs);
+        cb->setViewport(viewport);
+        cb->setShaderResources(m_particleSrb);
+        const QRhiCommandBuffer::VertexInput particleInput(m_particleVbuf, 0);
+        cb->setVertexInput(0, 1, &particleInput);
+        cb->draw(static_cast<quint32>(m_vertexCount));
+    }
+
+    cb->endPass();
+    m_current = dst;
+}
+
+// ═════════════════════════════════════════════════════════════════════════════
+// render  (dentro il render pass principale: solo composizione)
+// ═════════════════════════════════════════════════════════════════════════════
+
+void TrailNode::render(const RenderState *)
+{
+    if (!m_compositePs || !m_tex[m_current])
+        return;
+
+    QRhiCommandBuffer *cb = commandBuffer();
+    const QSize out = renderTarget()->pixelSize();
+
+    cb->setGraphicsPipeline(m_compositePs);
+    cb->setViewport(QRhiViewport(0, 0, out.width(), out.height()));
+    cb->setShaderResources(m_compositeSrb[m_current]);
+    const QRhiCommandBuffer::VertexInput quadInput(m_quadVbuf, 0);
+    cb->setVertexInput(0, 1, &quadInput);
+    cb->draw(4);
+}
+
+QSGRenderNode::StateFlags TrailNode::changedStates() const
+{
+    return ViewportState;
+}
+
+QSGRenderNode::RenderingFlags TrailNode::flags() const
+{
+    return BoundedRectRendering | NoExternalRendering;
+}
+
+QRectF TrailNode::rect() const
+{
+    return QRectF(QPointF(0, 0), m_itemSize);
+}
@@ -0,0 +1,88 @@
+#ifndef TRAILNODE_H
+#define TRAILNODE_H
+
+#include "TaoNew.h"
+
+#include <QSGRenderNode>
+#include <QMatrix4x4>
+#include <QSize>
+#include <rhi/qrhi.h>
+#include <vector>
+
+class QQuickWindow;
+
+// ── TrailNode ─────────────────────────────────────────────────────────────────
+// Scie delle particelle a costo costante: ogni frame le particelle vengono
+// disegnate in un render target offscreen (ping-pong tra due texture) che
+// contiene il frame precedente attenuato di `decay` per ogni 1/60 s trascorso.
+// Il risultato viene poi composto sotto il Tao. La lunghezza della scia non
+// aggiunge vertici.
+
+class TrailNode : public QSGRenderNode
+{
+public:
+    TrailNode(QQuickWindow *window, int capacity);
+    ~TrailNode() override;
+
+    // Chiamati da updatePaintNode (render thread, GUI bloccato)
+    void setItemSize  (const QSizeF &size, qreal dpr);
+    void setResolution(float scale);
+    void setDecay     (float decay);
+    void setFrameTime (float dt);
+    void setParticles (const ParticleVertex *vertices, int count);
+
+    void           prepare() override;
+    void           render(const RenderState *state) override;
+    void           releaseResources() override;
+    StateFlags     changedStates() const override;
+    RenderingFlags flags() const override;
+    QRectF         rect() const override;
+
+private:
+    bool ensureTargets(QRhi *rhi);
+    bool ensureOffscreenPipelines(QRhi *rhi);
+    bool ensureCompositePipeline(QRhi *rhi);
+    void releaseTargets();
+
+    QQuickWindow *m_window = nullptr;
+
+    // ── Parametri ─────────────────────────────────────────────────────────────
+    QSizeF m_itemSize;
+    qreal  m_dpr        = 1.0;
+    float  m_resolution = 0.5f;
+    float  m_decay      = 0.9f;
+    float  m_frameTime  = 0.0f;   // s da applicare al prossimo prepare
+
+    std::vector<ParticleVertex> m_vertices;   // preallocato a `capacity`
+    int                         m_vertexCount = 0;
+    bool                        m_freshParticles = false;   // step nuovo dall'ultimo prepare
+
+    // ── Risorse QRhi ──────────────────────────────────────────────────────────
+    QSize                    m_targetSize;
+    bool                     m_needsClear = true;
+    int                      m_current    = 0;   // texture con l'ultimo frame
+    float                    m_fade       = 1.0f / 255.0f;
+
+    QRhiTexture              *m_tex[2]      = { nullptr, nullptr };
+    QRhiTextureRenderTarget  *m_rt[2]       = { nullptr, nullptr };
+    QRhiRenderPassDescriptor *m_rtRp        = nullptr;
+    QRhiSampler              *m_sampler     = nullptr;
+
+    QRhiBuffer               *m_quadVbuf     = nullptr;
+    QRhiBuffer               *m_particleVbuf = nullptr;
+    QRhiBuffer               *m_decayUbuf    = nullptr;
+    QRhiBuffer               *m_particleUbuf = nullptr;
+    QRhiBuffer               *m_compositeUbuf = nullptr;
+    bool                      m_quadUploaded = false;
+
+    QRhiShaderResourceBindings *m_decaySrb[2]     = { nullptr, nullptr };
+    QRhiShaderResourceBindings *m_compositeSrb[2] = { nullptr, nullptr };
+    QRhiShaderResourceBindings *m_particleSrb     = nullptr;
+
+    QRhiGraphicsPipeline     *m_decayPs     = nullptr;
+    QRhiGraphicsPipeline     *m_particlePs  = nullptr;
+    QRhiGraphicsPipeline     *m_compositePs = nullptr;
+    QRhiRenderPassDescriptor *m_compositeRp = nullptr;   // non posseduto
+};
+
+#endif // TRAILNODE_H
@@ -7,6 +7,7 @@ layout(location = 2) in vec4 color;
 layout(std140, binding = 0) uniform buf {
     mat4  qt_Matrix;
     float qt_Opacity;
+    float sizeScale;   // 1.0 a schermo, < 1.0 nel buffer delle scie
 } ubuf;
 
 layout(location = 0) out vec4 v_color;
@@ -14,6 +15,6 @@ layout(location = 0) out vec4 v_color;
 void main()
 {
     gl_Position = ubuf.qt_Matrix * vec4(position, 0.0, 1.0);
-    gl_PointSize = size;
+    gl_PointSize = size * ubuf.sizeScale;
     v_color = color * ubuf.qt_Opacity;
 }
@@ -0,0 +1,18 @@
+#version 450
+
+layout(location = 0) in  vec2 v_uv;
+layout(location = 0) out vec4 fragColor;
+
+layout(std140, binding = 0) uniform buf {
+    mat4  mvp;
+    float factor;
+    float fade;
+} ubuf;
+
+layout(binding = 1) uniform sampler2D source;
+
+void main()
+{
+    vec4 c = texture(source, v_uv) * ubuf.factor;
+    fragColor = max(c - vec4(ubuf.fade), vec4(0.0));
+}
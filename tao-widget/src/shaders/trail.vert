@@ -0,0 +1,18 @@
+#version 450
+
+// Quad unitario [0,1]²: la stessa coordinata fa da posizione (via mvp) e da UV.
+layout(location = 0) in vec2 position;
+
+layout(std140, binding = 0) uniform buf {
+    mat4  mvp;
+    float factor;   // moltiplicatore colore (decadimento o opacità)
+    float fade;     // sottrazione costante: evita scie "bloccate" in 8 bit
+} ubuf;
+
+layout(location = 0) out vec2 v_uv;
+
+void main()
+{
+    v_uv = position;
+    gl_Position = ubuf.mvp * vec4(position, 0.0, 1.0);
+}
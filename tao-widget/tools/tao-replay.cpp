@@ -0,0 +1,208 @@
+// tao-replay — riesegue una registrazione (TAO_RECORD / recordPath) sul
+// kernel di simulazione, senza finestra né GPU.
+//
+//   tao-replay session.taorec --write-golden session.state
+//   tao-replay session.taorec --golden session.state [--tolerance 1e-3]
+//   tao-replay session.taorec --bench 20
+//   tao-replay session.taorec --count-allocations 60
+//
+// Exit code 0 = stato identico al riferimento (entro la tolleranza).
+
+#include "../src/ParticleSystem.h"
+#include "../src/SimulationWorker.h"
+#include "../src/TaoReplay.h"
+
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QTextStream>
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <vector>
+
+static constexpr int DEFAULT_CAPACITY = 3000;   // TaoNew::MAX_PARTICLES
+
+// ═════════════════════════════════════════════════════════════════════════════
+// Conteggio allocazioni (--count-allocations)
+// ═════════════════════════════════════════════════════════════════════════════
+// Con glibc si intercetta malloc stesso (tutti i thread, Qt compreso): new
+// passa comunque da lì. Altrove si ripiega su operator new.
+
+static std::atomic<bool> g_countAllocations { false };
+static std::atomic<long> g_allocations      { 0 };
+
+static inline void noteAllocation()
+{
+    if (g_countAllocations.load(std::memory_order_relaxed))
+        g_allocations.fetch_add(1, std::memory_order_relaxed);
+}
+
+#if defined(__GLIBC__)
+extern "C" {
+void *__libc_malloc(size_t);
+void *__libc_calloc(size_t, size_t);
+void *__libc_realloc(void *, size_t);
+void *__libc_memalign(size_t, size_t);
+
+void *malloc(size_t n)            { noteAllocation(); return __libc_malloc(n); }
+void *calloc(size_t n, size_t s)  { noteAllocation(); return __libc_calloc(n, s); }
+void *realloc(void *p, size_t n)  { noteAllocation(); return __libc_realloc(p, n); }
+void *memalign(size_t a, size_t n) { noteAllocation(); return __libc_memalign(a, n); }
+void *aligned_alloc(size_t a, size_t n) { noteAllocation(); return __libc_memalign(a, n); }
+int posix_memalign(void **out, size_t a, size_t n)
+{
+    noteAllocation();
+    *out = __libc_memalign(a, n);
+    return *out ? 0 : ENOMEM;
+}
+}
+#else
+void *operator new(size_t n)
+{
+    noteAllocation();
+    if (void *p = std::malloc(n ? n : 1))
+        return p;
+    throw std::bad_alloc();
+}
+void operator delete(void *p) noexcept         { std::free(p); }
+void operator delete(void *p, size_t) noexcept { std::free(p); }
+#endif
+
+// Percorso a regime di TaoNew senza Qt Quick: dispatch sul worker condiviso,
+// attesa, pubblicazione del prefisso vivo nel buffer "GPU".
+static long countSteadyStateAllocations(const SimulationRecording &rec, int capacity, int warmup)
+{
+    ParticleSystem              system(capacity);
+    std::vector<ParticleVertex> vertices(static_cast<size_t>(capacity));
+    std::vector<ParticleVertex> published(static_cast<size_t>(capacity));
+    SimulationJob               job(system, vertices.data());
+    SimulationWorker           &worker = SimulationWorker::instance();
+
+    system.reset(rec.seed);
+    system.clear(vertices.data());
+
+    for (size_t i = 0; i < rec.frames.size(); ++i) {
+        if (i == static_cast<size_t>(warmup))
+            g_countAllocations = true;
+
+        job.params = rec.frames[i];
+        worker.submit(&job);
+        worker.wait(&job);
+        std::memcpy(published.data(), vertices.data(),
+                    static_cast<size_t>(job.liveCount()) * sizeof(ParticleVertex));
+    }
+
+    g_countAllocations = false;
+    return g_allocations.load();
+}
+
+static void replay(const SimulationRecording &rec, ParticleSystem &system,
+                   std::vector<ParticleVertex> &vertices)
+{
+    system.reset(rec.seed);
+    system.clear(vertices.data());
+    for (const SimulationParams &params : rec.frames)
+        system.step(params, vertices.data());
+}
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName(QStringLiteral("tao-replay"));
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription(QStringLiteral("Replay a recorded Tao particle session headlessly."));
+    parser.addHelpOption();
+    parser.addPositionalArgument(QStringLiteral("recording"), QStringLiteral("Recorded session file."));
+
+    const QCommandLineOption goldenOpt(QStringLiteral("golden"),
+        QStringLiteral("Compare the final state with <file>."), QStringLiteral("file"));
+    const QCommandLineOption writeGoldenOpt(QStringLiteral("write-golden"),
+        QStringLiteral("Write the final state to <file>."), QStringLiteral("file"));
+    const QCommandLineOption toleranceOpt(QStringLiteral("tolerance"),
+        QStringLiteral("Absolute tolerance per field (default 1e-3)."), QStringLiteral("value"),
+        QStringLiteral("1e-3"));
+    const QCommandLineOption capacityOpt(QStringLiteral("capacity"),
+        QStringLiteral("Particle pool size (default %1).").arg(DEFAULT_CAPACITY), QStringLiteral("n"),
+        QString::number(DEFAULT_CAPACITY));
+    const QCommandLineOption benchOpt(QStringLiteral("bench"),
+        QStringLiteral("Replay <n> times and report the time per step."), QStringLiteral("n"));
+    const QCommandLineOption allocOpt(QStringLiteral("count-allocations"),
+        QStringLiteral("Fail if any heap allocation happens after <n> warm-up frames."),
+        QStringLiteral("n"));
+    parser.addOptions({ goldenOpt, writeGoldenOpt, toleranceOpt, capacityOpt, benchOpt, allocOpt });
+    parser.process(app);
+
+    QTextStream out(stdout);
+    QTextStream err(stderr);
+
+    const QStringList args = parser.positionalArguments();
+    if (args.size() != 1)
+        parser.showHelp(2);
+
+    SimulationRecording rec;
+    QString error;
+    if (!loadRecording(args.first(), &rec, &error)) {
+        err << error << Qt::endl;
+        return 2;
+    }
+
+    const int capacity = qMax(1, parser.value(capacityOpt).toInt());
+    ParticleSystem              system(capacity);
+    std::vector<ParticleVertex> vertices(static_cast<size_t>(capacity));
+
+    replay(rec, system, vertices);
+    out << rec.frames.size() << " frames, " << system.liveCount() << " live particles" << Qt::endl;
+
+    if (parser.isSet(benchOpt) && !rec.frames.empty()) {
+        const int runs = qMax(1, parser.value(benchOpt).toInt());
+        std::vector<qint64> perRun;
+        perRun.reserve(static_cast<size_t>(runs));
+        for (int r = 0; r < runs; ++r) {
+            QElapsedTimer timer;
+            timer.start();
+            replay(rec, system, vertices);
+            perRun.push_back(timer.nsecsElapsed());
+        }
+        std::sort(perRun.begin(), perRun.end());
+        const double frames = static_cast<double>(rec.frames.size());
+        out << "step: median " << perRun[perRun.size() / 2] / frames / 1000.0
+            << " us, min " << perRun.front() / frames / 1000.0 << " us" << Qt::endl;
+    }
+
+    if (parser.isSet(allocOpt)) {
+        const int warmup = qMax(0, parser.value(allocOpt).toInt());
+        if (static_cast<size_t>(warmup) >= rec.frames.size()) {
+            err << "recording too short for " << warmup << " warm-up frames" << Qt::endl;
+            return 2;
+        }
+        const long count = countSteadyStateAllocations(rec, capacity, warmup);
+        out << count << " allocations in " << rec.frames.size() - warmup
+            << " steady-state frames" << Qt::endl;
+        if (count != 0)
+            return 1;
+    }
+
+    if (parser.isSet(writeGoldenOpt)) {
+        if (!writeState(parser.value(writeGoldenOpt), system)) {
+            err << "cannot write " << parser.value(writeGoldenOpt) << Qt::endl;
+            return 2;
+        }
+    }
+
+    if (parser.isSet(goldenOpt)) {
+        QString report;
+        if (!compareState(parser.value(goldenOpt), system,
+                          parser.value(toleranceOpt).toFloat(), &report)) {
+            err << "MISMATCH: " << report << Qt::endl;
+            return 1;
+        }
+        out << "OK" << Qt::endl;
+    }
+
+    return 0;
+}